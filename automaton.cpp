@@ -1,431 +1,1514 @@
-#include "automaton.h"
-#include <stdexcept>
-#include <iostream>
-#include <queue>
-#include <vector>
-#include <fstream>
-#include <iterator>
-#include <algorithm>
-#include <map>
-#include <utility>
-
-Automaton::Automaton(std::istream& is)
-{
-    if(!is) throw std::runtime_error("Could not read from the file");
-    std::size_t finalStatesCount, transitionsCount;
-    is >> states >> finalStatesCount;
-    while(finalStatesCount--)
-    {
-        std::size_t f;
-        is >> f;
-        finalStates.insert(f);
-    }
-    is >> transitionsCount;
-    while(transitionsCount--)
-    {
-        std::size_t from, to;
-        char label;
-        is >> from >> label >> to;
-        if(from==to && label==epsilon) continue;
-        if(label!=epsilon) alpha.insert(label);
-        transitions.emplace(from, label, to);
-    }
-    if(!is) throw std::runtime_error("Wrong input");
-    deterministic=isDeterm();
-}
-
-bool Automaton::isFinal(std::size_t state) const
-{
-    return finalStates.find(state)!=finalStates.end();
-}
-
-bool Automaton::isDeterm() const
-{
-    if(transitions.size()!=states*alpha.size()) return false;
-    if(transitions.empty()) return true;
-    auto it1=transitions.begin(), it2=it1;
-    for(++it2; it2!=transitions.end(); ++it1, ++it2)
-        if(it1->Label()==epsilon || it1->From()==it2->From() && it1->Label()==it2->Label())
-            return false;
-    return it2->Label()!=epsilon;
-}
-
-bool Automaton::isDeterministic() const
-{
-    return deterministic;
-}
-
-bool Automaton::traverse(const char* word, std::size_t state, std::set<std::pair<const char*, std::size_t>>& s) const
-{
-    if(s.find(std::make_pair(word, state))!=s.end()) return false;
-    auto it=transitions.lower_bound(Transition(state, 0, 0)), end=transitions.upper_bound(Transition(state, 127, 0));
-    if(!*word)
-    {
-        for(; it!=end; ++it)
-            if(it->Label()==epsilon)
-            {
-                s.emplace(word, state);
-                if(traverse(word, it->To(), s)) return true;
-            }
-        return isFinal(state);
-    }
-    if(*word==epsilon) return traverse(word+1, state, s);
-    for(; it!=end; ++it)
-    {
-        if(it->Label()==*word && traverse(word+1, it->To(), s)) return true;
-        if(it->Label()==epsilon)
-        {
-            s.emplace(word, state);
-            if(traverse(word, it->To(), s)) return true;
-        }
-    }
-    return false;
-}
-
-bool Automaton::traverse(const char* word) const
-{
-    std::size_t state=0;
-    for(std::size_t i=0; word[i]; ++i)
-    {
-        if(word[i]==epsilon) continue;
-        auto it=transitions.lower_bound(Transition(state, word[i], 0));
-        if(it==transitions.end() || it->Label()!=word[i] || it->From()!=state) return false;
-        state=it->To();
-    }
-    return isFinal(state);
-}
-
-bool Automaton::operator()(const std::string& word) const
-{
-    if(deterministic) return traverse(word.c_str());
-    std::set<std::pair<const char*, std::size_t>> s;
-    return traverse(word.c_str(), 0, s);
-}
-
-Automaton Automaton::Union(const Automaton& a) const
-{
-    if(!states) return a;
-    if(!a.states) return *this;
-    Automaton res;
-    std::set_union(alpha.begin(), alpha.end(), a.alpha.begin(), a.alpha.end(), std::inserter(res.alpha, res.alpha.end()));
-    res.states=states+a.states+1;
-    res.deterministic=false;
-    res.transitions.emplace(0, epsilon, 1);
-    res.transitions.emplace(0, epsilon, states+1);
-    for(auto&& t: transitions)
-        res.transitions.emplace(t.From()+1, t.Label(), t.To()+1);
-    for(auto&& t: a.transitions)
-        res.transitions.emplace(t.From()+states+1, t.Label(), t.To()+states+1);
-    for(auto f: finalStates)
-        res.finalStates.insert(f+1);
-    for(auto f: a.finalStates)
-        res.finalStates.insert(f+states+1);
-    return res;
-}
-
-Automaton Automaton::Concatenation(const Automaton& a) const
-{
-    if(!states || !a.states || !finalStates.size()) return {};
-    Automaton res;
-    std::set_union(alpha.begin(), alpha.end(), a.alpha.begin(), a.alpha.end(), std::inserter(res.alpha, res.alpha.end()));
-    res.states=states+a.states;
-    res.deterministic=false;
-    res.transitions=transitions;
-    for(auto f: finalStates)
-        res.transitions.emplace(f, epsilon, states);
-    for(auto&& t: a.transitions)
-        res.transitions.emplace(t.From()+states, t.Label(), t.To()+states);
-    for(auto f: a.finalStates)
-        res.finalStates.insert(f+states);
-    return res;
-}
-
-Automaton Automaton::KleeneStar() const
-{
-    Automaton res;
-    res.alpha=alpha;
-    res.states=states+1;
-    res.deterministic=!states;
-    res.transitions.emplace(0, epsilon, 1);
-    for(auto&& t: transitions)
-        res.transitions.emplace(t.From()+1, t.Label(), t.To()+1);
-    res.finalStates.insert(0);
-    for(auto f: finalStates)
-    {
-        res.transitions.emplace(f+1, epsilon, 0);
-        res.finalStates.insert(f+1);
-    }
-    return res;
-}
-
-bool Automaton::isFinalStateReachable(std::size_t start) const
-{
-    if(!states) return false;
-    std::vector<bool> f(states);
-    std::queue<std::size_t> q;
-    q.push(start);
-    f[start]=true;
-    while(!q.empty())
-    {
-        auto v=q.front();
-        q.pop();
-        if(isFinal(v)) return true;
-        for(auto it=transitions.lower_bound(Transition(v, 0, 0)); it!=transitions.end() && it->From()==v; ++it)
-            if(!f[it->To()])
-            {
-                f[it->To()]=true;
-                q.push(it->To());
-            }
-    }
-    return false;
-}
-
-bool Automaton::acceptsTheEmptyLang() const
-{
-    return !isFinalStateReachable(0);
-}
-
-bool Automaton::existPathWithNonzeroLength(std::size_t from, std::size_t to) const
-{
-    if(!states) return false;
-    std::vector<bool> f(states);
-    std::queue<std::size_t> q;
-    q.push(from);
-    f[from]=true;
-    while(!q.empty())
-    {
-        auto v=q.front();
-        q.pop();
-        for(auto it=transitions.lower_bound(Transition(v, 0, 0)); it!=transitions.end() && it->From()==v; ++it)
-        {
-            if(it->To()==to) return true;
-            if(!f[it->To()])
-            {
-                f[it->To()]=true;
-                q.push(it->To());
-            }
-        }
-    }
-    return false;
-}
-
-bool Automaton::acceptsFiniteLang() const
-{
-    Automaton temp(*this);
-    temp.minimize();
-    for(std::size_t i=0; i<states; ++i)
-        if(isFinalStateReachable(i) && existPathWithNonzeroLength(i,i)) return false;
-    return true;
-}
-
-bool Automaton::save(const std::string& path) const
-{
-    std::ofstream ofs(path);
-    if(ofs)
-    {
-        ofs << *this;
-        return true;
-    }
-    return false;
-}
-
-void Automaton::addReachableThroughEps(std::set<std::size_t>& st) const
-{
-    std::set<std::size_t> tmp;
-    for(auto n: st)
-    {
-        std::vector<bool> f(states);
-        std::queue<std::size_t> q;
-        q.push(n);
-        f[n]=true;
-        while(!q.empty())
-        {
-            auto v=q.front();
-            q.pop();
-            tmp.insert(v);
-            for(auto it=transitions.lower_bound(Transition(v, epsilon, 0)); it!=transitions.end() && it->From()==v && it->Label()==epsilon; ++it)
-                if(!f[it->To()])
-                {
-                    f[it->To()]=true;
-                    q.push(it->To());
-                }
-        }
-    }
-    st=std::move(tmp);
-}
-
-bool Automaton::containsFinalState(const std::set<std::size_t>& st) const
-{
-    std::vector<std::size_t> intersection;
-    std::set_intersection(st.begin(), st.end(), finalStates.begin(), finalStates.end(), std::back_inserter(intersection));
-    return !intersection.empty();
-}
-
-Automaton& Automaton::convertToDFA()
-{
-    if(deterministic) return *this;
-    std::queue<std::set<std::size_t>> st;
-    st.push(std::set<std::size_t>{0});
-    addReachableThroughEps(st.front());
-    std::set<std::set<std::size_t>> visited;
-    visited.insert(st.front());
-    std::map<std::set<std::size_t>, std::size_t> newStates;
-    std::size_t c=0;
-    newStates[st.front()]=c++;
-    std::set<Transition> trans;
-    std::set<std::size_t> fin;
-    if(containsFinalState(st.front())) fin.insert(0);
-    while(!st.empty())
-    {
-        auto t=std::move(st.front());
-        st.pop();
-        for(char letter: alpha)
-        {
-            std::set<std::size_t> n;
-            for(auto oldState: t)
-            {
-                auto it=transitions.lower_bound(Transition(oldState, letter, 0));
-                for(; it!=transitions.end(); ++it)
-                    if(it->From()==oldState && it->Label()==letter)
-                        n.insert(it->To());
-                    else break;
-                if(it==transitions.end()) break;
-            }
-            addReachableThroughEps(n);
-            auto p=newStates.emplace(n,c);
-            if(p.second) ++c;
-            if(containsFinalState(n)) fin.insert(p.first->second);
-            trans.emplace(newStates[t], letter, p.first->second);
-            if(visited.insert(n).second)
-                st.push(std::move(n));
-        }
-    }
-    states=newStates.size();
-    transitions=std::move(trans);
-    finalStates=std::move(fin);
-    deterministic=true;
-    return *this;
-}
-
-void Automaton::removeUnreachableStates()
-{
-    if(!states) return;
-    std::vector<bool> f(states);
-    std::queue<std::size_t> q;
-    q.push(0);
-    f[0]=true;
-    while(!q.empty())
-    {
-        auto v=q.front();
-        q.pop();
-        for(auto it=transitions.lower_bound(Transition(v, 0, 0)); it!=transitions.end() && it->From()==v; ++it)
-            if(!f[it->To()])
-            {
-                f[it->To()]=true;
-                q.push(it->To());
-            }
-    }
-    states=0;
-    for(bool b: f)
-        if(b) ++states;
-    for(auto it=transitions.begin(); it!=transitions.end();)
-        if(!f[it->From()] || !f[it->To()]) it=transitions.erase(it);
-        else ++it;
-    for(auto it=finalStates.begin(); it!=finalStates.end();)
-        if(!f[*it]) it=finalStates.erase(it);
-        else ++it;
-}
-
-Automaton& Automaton::minimize()
-{
-    convertToDFA();
-    removeUnreachableStates();
-    if(finalStates.empty()) return *this=Automaton();
-    std::vector<int> belongTo(states);
-    for(auto f: finalStates)
-        belongTo[f]=1;
-    std::set<std::size_t> tmp;
-    for(std::size_t i=0; i<belongTo.size(); ++i)
-        if(!belongTo[i]) tmp.insert(tmp.end(), i);
-    std::set<std::set<std::size_t>> eqClasses{tmp, finalStates}, newEqClasses;
-    for(;;)
-    {
-        for(const auto& cl: eqClasses)
-        {
-            if(cl.empty()) continue;
-            if(cl.size()==1)
-            {
-                newEqClasses.insert(cl);
-                continue;
-            }
-            std::set<std::pair<std::vector<int>, std::size_t>> t;
-            for(auto st: cl)
-            {
-                std::vector<int> tr;
-                for(char letter: alpha)
-                    tr.push_back(belongTo[transitions.lower_bound(Transition(st,letter,0))->To()]);
-                t.emplace(std::move(tr), st);
-            }
-            auto it2=t.begin();
-            std::set<std::size_t> eqClass{it2->second};
-            for(auto it1=it2++; it2!=t.end(); ++it1, ++it2)
-            {
-                if(it1->first!=it2->first)
-                {
-                    newEqClasses.insert(std::move(eqClass));
-                    eqClass.clear();
-                }
-                eqClass.insert(it2->second);
-            }
-            newEqClasses.insert(std::move(eqClass));
-        }
-        if(eqClasses==newEqClasses) break;
-        eqClasses=std::move(newEqClasses);
-        newEqClasses.clear();
-        int c=0;
-        for(const auto& cl: eqClasses)
-        {
-            for(auto st: cl)
-                belongTo[st]=c;
-            ++c;
-        }
-    }
-    std::size_t c=1;
-    std::map<std::set<std::size_t>, std::size_t> newStates;
-    for(auto&& cl: eqClasses)
-        if(cl.count(0)) newStates[std::move(cl)]=0;
-        else newStates[std::move(cl)]=c++;
-    std::set<Transition> trans;
-    std::set<std::size_t> fin;
-    for(const auto& cl: newStates)
-    {
-        if(containsFinalState(cl.first))
-            fin.insert(cl.second);
-        for(auto st: cl.first)
-            belongTo[st]=cl.second;
-    }
-    for(const auto& cl: newStates)
-        for(char letter: alpha)
-            trans.emplace(cl.second, letter, belongTo[transitions.lower_bound(Transition(*cl.first.begin(),letter,0))->To()]);
-    states=newStates.size();
-    transitions=std::move(trans);
-    finalStates=std::move(fin);
-    return *this;
-}
-
-std::ostream& operator<<(std::ostream& os, const Automaton& a)
-{
-    os << a.states << ' ' << a.finalStates.size() << std::endl;
-    auto it=a.finalStates.begin();
-    if(it!=a.finalStates.end())
-    {
-        os << *it;
-        while(++it!=a.finalStates.end())
-            os << ' ' << *it;
-        os << std::endl;
-    }
-    os << a.transitions.size() << std::endl;
-    for(auto&& x: a.transitions)
-        os << x.From() << ' ' << x.Label() << ' ' << x.To() << std::endl;
-    return os;
-}
+#include "automaton.h"
+#include <stdexcept>
+#include <iostream>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+#include <map>
+#include <utility>
+#include <limits>
+#include <cstdint>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <cstring>
+#include <cstdio>
+#include <charconv>
+#include <system_error>
+#include "subsetTable.h"
+#include "mappedFile.h"
+
+namespace
+{
+    /// Layout of the binary format, in native byte order: the header, the bitmap of final states
+    /// and the CSR arrays of the transition table (offsets, targets, labels), each starting at a multiple of 8 bytes.
+    struct BinaryHeader
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint32_t flags;
+        std::uint64_t states;
+        std::uint64_t edges;
+        std::uint64_t alphabet[4];
+    };
+    constexpr char binaryMagic[4]={'N', 'F', 'A', 'B'};
+    constexpr std::uint32_t binaryVersion=1, binaryByteOrder=0x01020304;
+
+    std::size_t bitmapWords(std::size_t bits)
+    {
+        return (bits+63)/64;
+    }
+
+    /// Tokenizer of the text format; tokens are separated by whitespace, a label is a single character.
+    struct TextReader
+    {
+        const char* p;
+        const char* last;
+        void skip()
+        {
+            while(p!=last && (*p==' ' || *p=='\n' || *p=='\r' || *p=='\t' || *p=='\v' || *p=='\f')) ++p;
+        }
+        bool number(std::size_t& n)
+        {
+            skip();
+            auto res=std::from_chars(p, last, n);
+            p=res.ptr;
+            return res.ec==std::errc();
+        }
+        bool letter(char& c)
+        {
+            skip();
+            if(p==last) return false;
+            c=*p++;
+            return true;
+        }
+    };
+
+    /// Output buffer of operator<<, written to the stream whenever it fills up.
+    class TextWriter
+    {
+        std::ostream& os;
+        char buffer[1<<16];
+        std::size_t used=0;
+    public:
+        explicit TextWriter(std::ostream& os): os(os) {}
+        ~TextWriter()
+        {
+            flush();
+        }
+        void flush()
+        {
+            os.write(buffer, used);
+            used=0;
+        }
+        TextWriter& operator<<(std::size_t n)
+        {
+            if(used+20>sizeof buffer) flush();
+            used=std::to_chars(buffer+used, buffer+sizeof buffer, n).ptr-buffer;
+            return *this;
+        }
+        TextWriter& operator<<(char c)
+        {
+            if(used==sizeof buffer) flush();
+            buffer[used++]=c;
+            return *this;
+        }
+    };
+}
+
+/// Reads the rest of the stream in blocks and parses it as the text format.
+Automaton::Automaton(std::istream& is)
+{
+    if(!is) throw std::runtime_error("Could not read from the file");
+    std::vector<char> buffer;
+    for(std::size_t length=std::size_t(1)<<16; is; length*=2)
+    {
+        std::size_t held=buffer.size();
+        buffer.resize(held+length);
+        is.read(buffer.data()+held, length);
+        buffer.resize(held+is.gcount());
+    }
+    read(buffer.data(), buffer.data()+buffer.size());
+}
+
+/// Opens a file in either format. A binary file is used in place: the transition table views the mapped file.
+Automaton::Automaton(const std::string& path)
+{
+    auto file=std::make_shared<const MappedFile>(path);
+    if(file->size()>=sizeof(BinaryHeader) && std::equal(binaryMagic, binaryMagic+4, file->data())) read(std::move(file));
+    else read(file->data(), file->data()+file->size());
+}
+
+void Automaton::read(std::shared_ptr<const MappedFile> file)
+{
+    BinaryHeader h;
+    std::memcpy(&h, file->data(), sizeof h);
+    if(h.version!=binaryVersion || h.byteOrder!=binaryByteOrder) throw std::runtime_error("Unsupported file format");
+    if(h.states>=file->size() || h.edges>=file->size()) throw std::runtime_error("Wrong input");
+    std::size_t words=bitmapWords(h.states), edges=h.edges;
+    std::size_t finalsAt=sizeof h, offsetsAt=finalsAt+words*8, targetsAt=offsetsAt+(h.states+1)*8, labelsAt=targetsAt+edges*8;
+    if(file->size()!=labelsAt+edges) throw std::runtime_error("Wrong input");
+    states=h.states;
+    for(int c=0; c<256; ++c)
+        if(h.alphabet[c/64]>>(c%64)&1)
+        {
+            if(c==static_cast<unsigned char>(epsilon)) throw std::runtime_error("Wrong input");
+            alpha.insert(static_cast<char>(c));
+        }
+    auto bits=reinterpret_cast<const std::uint64_t*>(file->data()+finalsAt);
+    for(std::size_t w=0; w<words; ++w)
+        for(auto b=bits[w]; b; b&=b-1)
+        {
+            std::size_t f=w*64+__builtin_ctzll(b);
+            if(f>=states) throw std::runtime_error("Wrong input");
+            finalStates.insert(finalStates.end(), f);
+        }
+    auto labels=file->data()+labelsAt;
+    auto offsets=reinterpret_cast<const std::uint64_t*>(file->data()+offsetsAt);
+    auto targets=reinterpret_cast<const std::uint64_t*>(file->data()+targetsAt);
+    if(offsets[0] || offsets[states]!=edges) throw std::runtime_error("Wrong input");
+    for(std::size_t s=0; s<states; ++s)
+    {
+        if(offsets[s]>offsets[s+1]) throw std::runtime_error("Wrong input");
+        for(auto e=offsets[s]; e<offsets[s+1]; ++e)
+        {
+            if(targets[e]>=states || (labels[e]!=epsilon && !(h.alphabet[static_cast<unsigned char>(labels[e])/64]>>(static_cast<unsigned char>(labels[e])%64)&1))) throw std::runtime_error("Wrong input");
+            if(e>offsets[s] && !(labels[e-1]<labels[e] || (labels[e-1]==labels[e] && targets[e-1]<targets[e]))) throw std::runtime_error("Wrong input");
+        }
+    }
+    if constexpr(sizeof(std::size_t)==sizeof(std::uint64_t))
+        transitions=TransitionTable(states, edges, reinterpret_cast<const std::size_t*>(offsets), labels, reinterpret_cast<const std::size_t*>(targets), std::move(file));
+    else
+    {
+        std::vector<Transition> trans;
+        trans.reserve(edges);
+        for(std::size_t s=0; s<states; ++s)
+            for(auto e=offsets[s]; e<offsets[s+1]; ++e)
+                trans.emplace_back(s, labels[e], targets[e]);
+        transitions=TransitionTable(states, std::move(trans));
+    }
+    deterministic=isDeterm();
+}
+
+void Automaton::read(const char* first, const char* last)
+{
+    TextReader in{first, last};
+    std::size_t finalStatesCount, transitionsCount;
+    if(!in.number(states) || !in.number(finalStatesCount)) throw std::runtime_error("Wrong input");
+    std::vector<std::size_t> fin;
+    fin.reserve(std::min<std::size_t>(finalStatesCount, (last-first)/2));
+    while(finalStatesCount--)
+    {
+        std::size_t f;
+        if(!in.number(f) || f>=states) throw std::runtime_error("Wrong input");
+        fin.push_back(f);
+    }
+    std::sort(fin.begin(), fin.end());
+    finalStates.insert(fin.begin(), std::unique(fin.begin(), fin.end()));
+    if(!in.number(transitionsCount)) throw std::runtime_error("Wrong input");
+    std::vector<Transition> trans;
+    trans.reserve(std::min<std::size_t>(transitionsCount, (last-first)/6));
+    bool letters[256]={};
+    while(transitionsCount--)
+    {
+        std::size_t from, to;
+        char label;
+        if(!in.number(from) || !in.letter(label) || !in.number(to) || from>=states || to>=states) throw std::runtime_error("Wrong input");
+        if(from==to && label==epsilon) continue;
+        if(label!=epsilon) letters[static_cast<unsigned char>(label)]=true;
+        trans.emplace_back(from, label, to);
+    }
+    for(int c=0; c<256; ++c)
+        if(letters[c]) alpha.insert(static_cast<char>(c));
+    transitions=TransitionTable(states, std::move(trans));
+    deterministic=isDeterm();
+}
+
+/// Drops the matchers and everything else built from the transitions; they are built again when needed.
+void Automaton::discardCompiled()
+{
+    compiled=std::make_shared<Matchers>();
+}
+
+const std::shared_ptr<const EpsilonClosure>& Automaton::epsilonClosures() const
+{
+    std::call_once(compiled->closed, [this] {compiled->closures=std::make_shared<const EpsilonClosure>(transitions);});
+    return compiled->closures;
+}
+
+/// Small deterministic automata also get a matcher with a narrow state type; the compiled DFA still serves streaming.
+const Automaton::Matchers& Automaton::matchers() const
+{
+    std::call_once(compiled->built, [this]
+    {
+        auto& m=*compiled;
+        if(!deterministic)
+        {
+            m.simulator=std::make_shared<const NFASimulator>(transitions, epsilonClosures(), alpha, finalStates);
+            try
+            {
+                m.lazy=std::make_shared<LazyDFA>(transitions, m.closures, m.simulator, alpha, finalStates);
+            }
+            catch(const std::length_error&) {}
+            return;
+        }
+        if(SmallMatcher<std::uint8_t>::fits(states, alpha.size()))
+            m.matcher8=std::make_shared<const SmallMatcher<std::uint8_t>>(transitions, alpha, finalStates, epsilon);
+        else if(SmallMatcher<std::uint16_t>::fits(states, alpha.size()))
+            m.matcher16=std::make_shared<const SmallMatcher<std::uint16_t>>(transitions, alpha, finalStates, epsilon);
+        try
+        {
+            m.matcher=std::make_shared<const CompiledDFA>(transitions, alpha, finalStates);
+        }
+        catch(const std::length_error&) {}
+    });
+    return *compiled;
+}
+
+template<typename T>
+T Automaton::cached(T Language::* member) const
+{
+    std::lock_guard<std::mutex> guard(language->mutex);
+    return (*language).*member;
+}
+
+template<typename T>
+void Automaton::cache(T Language::* member, const T& value) const
+{
+    std::lock_guard<std::mutex> guard(language->mutex);
+    (*language).*member=value;
+}
+
+/// A copy to be kept by the cache of a language. It gets a cache of its own, so caches never hold each other in a cycle.
+std::shared_ptr<const Automaton> Automaton::snapshot() const
+{
+    auto res=std::make_shared<Automaton>(*this);
+    res->language=std::make_shared<Language>();
+    return res;
+}
+
+/// Deterministic automata whose union is the language, as far as they are at hand without determinizing; none otherwise.
+std::vector<std::shared_ptr<const Automaton>> Automaton::unionParts() const
+{
+    std::lock_guard<std::mutex> guard(language->mutex);
+    if(deterministic) return {snapshot()};
+    if(language->dfa) return {language->dfa};
+    return language->parts;
+}
+
+bool Automaton::isFinal(std::size_t state) const
+{
+    return finalStates.find(state)!=finalStates.end();
+}
+
+bool Automaton::isDeterm() const
+{
+    if(transitions.size()!=states*alpha.size()) return false;
+    for(std::size_t s=0; s<states; ++s)
+        for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+            if(transitions.label(e)==epsilon || (e>transitions.begin(s) && transitions.label(e-1)==transitions.label(e)))
+                return false;
+    return true;
+}
+
+bool Automaton::isDeterministic() const
+{
+    return deterministic;
+}
+
+bool Automaton::traverse(const char* word) const
+{
+    if(!states) return false;
+    std::size_t state=0;
+    for(std::size_t i=0; word[i]; ++i)
+    {
+        if(word[i]==epsilon) continue;
+        auto e=transitions.lowerBound(state, word[i]);
+        if(e==transitions.end(state) || transitions.label(e)!=word[i]) return false;
+        state=transitions.target(e);
+    }
+    return isFinal(state);
+}
+
+bool Automaton::operator()(const std::string& word) const
+{
+    auto& m=matchers();
+    if(m.matcher8) return (*m.matcher8)(word.data(), word.size());
+    if(m.matcher16) return (*m.matcher16)(word.data(), word.size());
+    if(m.matcher) return (*m.matcher)(word.data(), word.size());
+    if(m.lazy) return (*m.lazy)(word.data(), word.size());
+    if(m.simulator) return (*m.simulator)(word.data(), word.size());
+    return traverse(word.c_str());
+}
+
+StreamMatcher Automaton::stream() const
+{
+    auto& m=matchers();
+    if(m.matcher) return StreamMatcher(m.matcher, nullptr, nullptr);
+    if(m.lazy) return StreamMatcher(nullptr, std::make_unique<LazyDFA>(transitions, m.closures, m.simulator, alpha, finalStates), nullptr);
+    if(m.simulator) return StreamMatcher(nullptr, nullptr, m.simulator);
+    return StreamMatcher(nullptr, nullptr, std::make_shared<const NFASimulator>(transitions, epsilonClosures(), alpha, finalStates));
+}
+
+/// Reads the word from the stream in blocks; line terminators at the very end are not part of the word.
+bool Automaton::recognize(std::istream& is) const
+{
+    if(!is) throw std::runtime_error("Could not read from the file");
+    auto m=stream();
+    std::vector<char> buffer(std::size_t(1)<<16);
+    std::size_t held=0;
+    while(is.read(buffer.data()+held, buffer.size()-held) || is.gcount())
+    {
+        std::size_t length=held+is.gcount(), word=length;
+        while(word && (buffer[word-1]=='\n' || buffer[word-1]=='\r')) --word;
+        if(!word && length==buffer.size()) word=length;
+        m.feed(buffer.data(), word);
+        held=length-word;
+        std::copy(buffer.begin()+word, buffer.begin()+length, buffer.begin());
+    }
+    return m.finish();
+}
+
+/// Tests every line of the buffer (a terminating '\r' is not part of the word) and returns how many are accepted.
+/// The buffer is cut at line boundaries into shards that the threads take in turn, each with its own matcher;
+/// with a compiled DFA the lines of a shard are matched several at a time.
+std::size_t Automaton::recognizeLines(const char* data, std::size_t size, std::size_t& lines, unsigned threads) const
+{
+    if(!threads) threads=1;
+    constexpr std::size_t shardsPerThread=8;
+    std::vector<std::size_t> cuts{0};
+    for(std::size_t i=1; i<threads*shardsPerThread && cuts.back()<size; ++i)
+    {
+        std::size_t at=std::max(cuts.back(), size/(threads*shardsPerThread)*i);
+        auto nl=static_cast<const char*>(std::memchr(data+at, '\n', size-at));
+        cuts.push_back(nl ? nl-data+1 : size);
+    }
+    if(cuts.back()<size) cuts.push_back(size);
+    std::atomic<std::size_t> next(0);
+    std::vector<std::size_t> accepted(threads), counted(threads);
+    auto& matcher=matchers().matcher;
+    auto work=[&](unsigned worker)
+    {
+        auto m=stream();
+        std::vector<std::uint32_t> offsets, lengths;
+        for(std::size_t shard; (shard=next.fetch_add(1))+1<cuts.size();)
+        {
+            auto first=data+cuts[shard], last=data+cuts[shard+1];
+            bool batched=matcher && last-first<=std::numeric_limits<std::uint32_t>::max();
+            offsets.clear();
+            lengths.clear();
+            for(auto p=first; p<last;)
+            {
+                auto nl=static_cast<const char*>(std::memchr(p, '\n', last-p));
+                auto end=nl ? nl : last;
+                std::size_t length=end-p-(end>p && end[-1]=='\r');
+                if(batched)
+                {
+                    offsets.push_back(p-first);
+                    lengths.push_back(length);
+                }
+                else
+                {
+                    m.feed(p, length);
+                    accepted[worker]+=m.finish();
+                }
+                ++counted[worker];
+                p=end+1;
+            }
+            if(batched) accepted[worker]+=matcher->countAccepted(first, last-first, offsets.data(), lengths.data(), offsets.size());
+        }
+    };
+    std::vector<std::thread> workers;
+    for(unsigned w=1; w<threads && w+1<cuts.size(); ++w)
+        workers.emplace_back(work, w);
+    work(0);
+    for(auto& w: workers)
+        w.join();
+    lines=0;
+    std::size_t res=0;
+    for(unsigned w=0; w<threads; ++w)
+    {
+        lines+=counted[w];
+        res+=accepted[w];
+    }
+    return res;
+}
+
+Automaton Automaton::Union(const Automaton& a) const&
+{
+    return Automaton(*this).uniteWith(a);
+}
+
+Automaton Automaton::Union(const Automaton& a) &&
+{
+    return std::move(uniteWith(a));
+}
+
+Automaton Automaton::Concatenation(const Automaton& a) const&
+{
+    return Automaton(*this).concatenateWith(a);
+}
+
+Automaton Automaton::Concatenation(const Automaton& a) &&
+{
+    return std::move(concatenateWith(a));
+}
+
+Automaton Automaton::KleeneStar() const&
+{
+    return Automaton(*this).applyKleeneStar();
+}
+
+Automaton Automaton::KleeneStar() &&
+{
+    return std::move(applyKleeneStar());
+}
+
+/// The combinators below work on the arrays of the transition table directly. The arrays of this automaton are reused
+/// when nothing else shares them. Transitions of a block of states keep their order when the block is renumbered, so every
+/// operand is copied or shifted in bulk and the few new epsilon transitions are merged in at their sorted positions, in linear time.
+/// The state numbering is the same as that of the constructions in the definition of the operations.
+Automaton& Automaton::uniteWith(const Automaton& a)
+{
+    if(!a.states) return *this;
+    if(!states) return *this=a;
+    if(&a==this) return uniteWith(Automaton(a));
+    auto empty=cached(&Language::empty), emptyA=a.cached(&Language::empty);
+    auto finite=cached(&Language::finite), finiteA=a.cached(&Language::finite);
+    auto parts=unionParts(), partsA=a.unionParts();
+    discardCompiled();
+    auto t=std::move(transitions).release();
+    const auto& b=a.transitions;
+    std::size_t edges=t.labels.size();
+    /// the new initial state 0 has epsilon transitions to both former initial states
+    t.offsets.resize(states+a.states+2);
+    std::move_backward(t.offsets.begin(), t.offsets.begin()+states+1, t.offsets.begin()+states+2);
+    t.offsets[0]=0;
+    for(std::size_t s=1; s<=states+1; ++s)
+        t.offsets[s]+=2;
+    for(std::size_t s=1; s<=a.states; ++s)
+        t.offsets[states+1+s]=b.offsetData()[s]+edges+2;
+    t.labels.reserve(edges+b.size()+2);
+    t.labels.insert(t.labels.begin(), 2, epsilon);
+    t.labels.insert(t.labels.end(), b.labelData(), b.labelData()+b.size());
+    for(auto& target: t.targets)
+        ++target;
+    t.targets.reserve(edges+b.size()+2);
+    t.targets.insert(t.targets.begin(), {1, states+1});
+    for(std::size_t e=0; e<b.size(); ++e)
+        t.targets.push_back(b.targetData()[e]+states+1);
+    /// the nodes of the set are reused for the renumbered final states
+    std::set<std::size_t> fin;
+    while(!finalStates.empty())
+    {
+        auto node=finalStates.extract(finalStates.begin());
+        ++node.value();
+        fin.insert(fin.end(), std::move(node));
+    }
+    for(auto f: a.finalStates)
+        fin.insert(fin.end(), f+states+1);
+    finalStates=std::move(fin);
+    alpha.insert(a.alpha.begin(), a.alpha.end());
+    states+=a.states+1;
+    transitions=TransitionTable(std::move(t));
+    deterministic=false;
+    language=std::make_shared<Language>();
+    if(empty==false || emptyA==false) language->empty=false;
+    else if(empty==true && emptyA==true) language->empty=true;
+    if(finite==false || finiteA==false) language->finite=false;
+    else if(finite==true && finiteA==true) language->finite=true;
+    if(!parts.empty() && !partsA.empty())
+    {
+        parts.insert(parts.end(), partsA.begin(), partsA.end());
+        language->parts=std::move(parts);
+    }
+    return *this;
+}
+
+Automaton& Automaton::concatenateWith(const Automaton& a)
+{
+    if(!states || !a.states || finalStates.empty()) return *this=Automaton();
+    if(&a==this) return concatenateWith(Automaton(a));
+    auto empty=cached(&Language::empty), emptyA=a.cached(&Language::empty);
+    auto finite=cached(&Language::finite), finiteA=a.cached(&Language::finite);
+    discardCompiled();
+    auto t=std::move(transitions).release();
+    const auto& b=a.transitions;
+    std::size_t edges=t.labels.size(), added=finalStates.size();
+    /// every final state gets an epsilon transition to the initial state of a, which is numbered after all states here,
+    /// so it goes last among the epsilon transitions of that state; the arrays are rearranged from the back
+    t.labels.resize(edges+added);
+    t.targets.resize(edges+added);
+    auto shiftEdge=[&](std::size_t e, std::size_t shift)
+    {
+        t.labels[e+shift]=t.labels[e];
+        t.targets[e+shift]=t.targets[e];
+    };
+    auto f=finalStates.rbegin();
+    for(std::size_t s=states, shift=added, last=edges; s--;)
+    {
+        std::size_t first=t.offsets[s], e=last;
+        if(f!=finalStates.rend() && *f==s)
+        {
+            std::size_t split=std::upper_bound(t.labels.begin()+first, t.labels.begin()+last, epsilon)-t.labels.begin();
+            for(; e>split; --e)
+                shiftEdge(e-1, shift);
+            --shift;
+            t.labels[e+shift]=epsilon;
+            t.targets[e+shift]=states;
+            ++f;
+        }
+        for(; e>first; --e)
+            shiftEdge(e-1, shift);
+        t.offsets[s]=first+shift;
+        last=first;
+    }
+    t.offsets.resize(states+a.states+1);
+    for(std::size_t s=0; s<=a.states; ++s)
+        t.offsets[states+s]=b.offsetData()[s]+edges+added;
+    t.labels.insert(t.labels.end(), b.labelData(), b.labelData()+b.size());
+    t.targets.reserve(edges+added+b.size());
+    for(std::size_t e=0; e<b.size(); ++e)
+        t.targets.push_back(b.targetData()[e]+states);
+    std::set<std::size_t> fin;
+    for(auto f: a.finalStates)
+        fin.insert(fin.end(), f+states);
+    finalStates=std::move(fin);
+    alpha.insert(a.alpha.begin(), a.alpha.end());
+    states+=a.states;
+    transitions=TransitionTable(std::move(t));
+    deterministic=false;
+    language=std::make_shared<Language>();
+    if(empty==true || emptyA==true) language->empty=language->finite=true;
+    else if(empty==false && emptyA==false)
+    {
+        language->empty=false;
+        if(finite==true && finiteA==true) language->finite=true;
+        else if(finite==false || finiteA==false) language->finite=false;
+    }
+    return *this;
+}
+
+Automaton& Automaton::applyKleeneStar()
+{
+    auto empty=cached(&Language::empty), finite=cached(&Language::finite);
+    discardCompiled();
+    auto t=std::move(transitions).release();
+    std::size_t edges=t.labels.size(), added=finalStates.size();
+    /// states move up by one for the new initial state 0, which is final and has an epsilon transition to the former one;
+    /// every final state gets an epsilon transition to state 0, which goes first among its epsilon transitions
+    t.offsets.resize(states+2);
+    t.labels.resize(edges+added+(states>0));
+    t.targets.resize(edges+added+(states>0));
+    auto shiftEdge=[&](std::size_t e, std::size_t shift)
+    {
+        t.labels[e+shift]=t.labels[e];
+        t.targets[e+shift]=t.targets[e]+1;
+    };
+    auto f=finalStates.rbegin();
+    for(std::size_t s=states, shift=added+1, last=edges; s--;)
+    {
+        std::size_t first=t.offsets[s], e=last;
+        if(f!=finalStates.rend() && *f==s)
+        {
+            std::size_t split=std::lower_bound(t.labels.begin()+first, t.labels.begin()+last, epsilon)-t.labels.begin();
+            for(; e>split; --e)
+                shiftEdge(e-1, shift);
+            --shift;
+            t.labels[e+shift]=epsilon;
+            t.targets[e+shift]=0;
+            ++f;
+        }
+        for(; e>first; --e)
+            shiftEdge(e-1, shift);
+        t.offsets[s+1]=first+shift;
+        last=first;
+    }
+    t.offsets[0]=0;
+    t.offsets[states+1]=t.labels.size();
+    if(states)
+    {
+        t.labels[0]=epsilon;
+        t.targets[0]=1;
+    }
+    std::set<std::size_t> fin{0};
+    while(!finalStates.empty())
+    {
+        auto node=finalStates.extract(finalStates.begin());
+        ++node.value();
+        fin.insert(fin.end(), std::move(node));
+    }
+    finalStates=std::move(fin);
+    deterministic=!states;
+    ++states;
+    transitions=TransitionTable(std::move(t));
+    /// the star of a language is finite only when the language holds no word but the empty one
+    language=std::make_shared<Language>();
+    language->empty=false;
+    if(empty==true) language->finite=true;
+    else if(empty==false && finite==false) language->finite=false;
+    return *this;
+}
+
+/// Appends the transitions of the automaton with every state number increased by shift.
+void Automaton::appendTransitions(std::pmr::vector<Transition>& res, std::size_t shift) const
+{
+    for(std::size_t s=0; s<states; ++s)
+        for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+            res.emplace_back(s+shift, transitions.label(e), transitions.target(e)+shift);
+}
+
+/// Target of the transition of a deterministic automaton; states stands for the dead state, both as argument and as result.
+std::size_t Automaton::next(std::size_t state, char letter) const
+{
+    if(state>=states) return states;
+    auto e=transitions.lowerBound(state, letter);
+    return e<transitions.end(state) && transitions.label(e)==letter ? transitions.target(e) : states;
+}
+
+/// Marks the states from which a final state can be reached.
+std::vector<bool> Automaton::coreachableStates() const
+{
+    std::vector<std::size_t> inOffsets(states+1), inSources(transitions.size());
+    for(std::size_t e=0; e<transitions.size(); ++e)
+        ++inOffsets[transitions.target(e)+1];
+    for(std::size_t s=0; s<states; ++s)
+        inOffsets[s+1]+=inOffsets[s];
+    {
+        auto pos=inOffsets;
+        for(std::size_t s=0; s<states; ++s)
+            for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+                inSources[pos[transitions.target(e)]++]=s;
+    }
+    std::vector<bool> res(states);
+    std::vector<std::size_t> stack(finalStates.begin(), finalStates.end());
+    for(auto f: stack)
+        res[f]=true;
+    while(!stack.empty())
+    {
+        auto s=stack.back();
+        stack.pop_back();
+        for(auto i=inOffsets[s]; i<inOffsets[s+1]; ++i)
+            if(!res[inSources[i]])
+            {
+                res[inSources[i]]=true;
+                stack.push_back(inSources[i]);
+            }
+    }
+    return res;
+}
+
+/// Reachable part of the product of the deterministic versions of both automata over the union of their alphabets.
+/// A pair is final when accept(final in this, final in a) holds; pairs in which neither automaton can accept any more,
+/// or one of them cannot and accept needs it to, are merged into a single dead pair, so the result is complete.
+/// accept(false, false) must not hold.
+Automaton Automaton::product(const Automaton& a, bool (*accept)(bool, bool)) const
+{
+    Automaton x=*this, y=a;
+    x.convertToDFA();
+    y.convertToDFA();
+    Automaton res;
+    std::set_union(alpha.begin(), alpha.end(), a.alpha.begin(), a.alpha.end(), std::inserter(res.alpha, res.alpha.end()));
+    bool keepDeadX=accept(false, true), keepDeadY=accept(true, false);
+    auto liveX=x.coreachableStates(), liveY=y.coreachableStates();
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::unordered_map<std::size_t, std::size_t> id(&arena);
+    std::pmr::vector<std::pair<std::size_t, std::size_t>> pairs(&arena);
+    auto visit=[&](std::size_t p, std::size_t q)
+    {
+        if(p<x.states && !liveX[p]) p=x.states;
+        if(q<y.states && !liveY[q]) q=y.states;
+        if((p==x.states && (q==y.states || !keepDeadX)) || (q==y.states && !keepDeadY))
+        {
+            p=x.states;
+            q=y.states;
+        }
+        auto it=id.emplace(p*(y.states+1)+q, pairs.size());
+        if(it.second) pairs.emplace_back(p, q);
+        return it.first->second;
+    };
+    visit(0, 0);
+    if(pairs[0]==std::make_pair(x.states, y.states)) return res;
+    std::pmr::vector<Transition> trans(&arena);
+    for(std::size_t i=0; i<pairs.size(); ++i)
+    {
+        auto p=pairs[i].first, q=pairs[i].second;
+        if(accept(x.isFinal(p), y.isFinal(q))) res.finalStates.insert(res.finalStates.end(), i);
+        for(char letter: res.alpha)
+            trans.emplace_back(i, letter, visit(x.next(p, letter), y.next(q, letter)));
+    }
+    res.states=pairs.size();
+    res.transitions=TransitionTable(res.states, trans.data(), trans.data()+trans.size());
+    return res;
+}
+
+Automaton Automaton::Intersection(const Automaton& a) const
+{
+    return product(a, [](bool x, bool y) {return x && y;});
+}
+
+Automaton Automaton::Difference(const Automaton& a) const
+{
+    return product(a, [](bool x, bool y) {return x && !y;});
+}
+
+/// Complement with respect to the words over the alphabet of the automaton: the deterministic version is completed
+/// with a dead state and the final states are swapped.
+Automaton Automaton::Complement() const
+{
+    Automaton res=*this;
+    res.convertToDFA();
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<Transition> trans(&arena);
+    res.appendTransitions(trans, 0);
+    bool complete=res.states;
+    for(std::size_t s=0; s<res.states; ++s)
+        for(char letter: res.alpha)
+            if(res.next(s, letter)==res.states)
+            {
+                trans.emplace_back(s, letter, res.states);
+                complete=false;
+            }
+    if(!complete)
+    {
+        for(char letter: res.alpha)
+            trans.emplace_back(res.states, letter, res.states);
+        ++res.states;
+    }
+    std::set<std::size_t> fin;
+    for(std::size_t s=0; s<res.states; ++s)
+        if(!res.isFinal(s)) fin.insert(fin.end(), s);
+    res.finalStates=std::move(fin);
+    res.transitions=TransitionTable(res.states, trans.data(), trans.data()+trans.size());
+    res.deterministic=true;
+    res.discardCompiled();
+    res.language=std::make_shared<Language>();
+    return res;
+}
+
+/// Hopcroft-Karp: the pairs of states reached by the same word are merged in a union-find structure without minimizing.
+/// If a pair with exactly one final state is met, the word leading to it (the shortest such one found) is stored in counterexample.
+bool Automaton::acceptsTheSameLang(const Automaton& a, std::string& counterexample) const
+{
+    Automaton x=*this, y=a;
+    x.convertToDFA();
+    y.convertToDFA();
+    std::set<char> letters;
+    std::set_union(alpha.begin(), alpha.end(), a.alpha.begin(), a.alpha.end(), std::inserter(letters, letters.end()));
+    std::vector<std::size_t> parent(x.states+y.states+2);
+    for(std::size_t i=0; i<parent.size(); ++i)
+        parent[i]=i;
+    auto find=[&](std::size_t v)
+    {
+        while(parent[v]!=v)
+            v=parent[v]=parent[parent[v]];
+        return v;
+    };
+    struct Pair
+    {
+        std::size_t p, q, from;
+        char letter;
+    };
+    std::vector<Pair> pairs{{0, 0, 0, epsilon}};
+    parent[x.states+1]=0;
+    for(std::size_t i=0; i<pairs.size(); ++i)
+    {
+        auto p=pairs[i].p, q=pairs[i].q;
+        if(x.isFinal(p)!=y.isFinal(q))
+        {
+            counterexample.clear();
+            for(auto j=i; j; j=pairs[j].from)
+                counterexample.push_back(pairs[j].letter);
+            std::reverse(counterexample.begin(), counterexample.end());
+            if(counterexample.empty()) counterexample.push_back(epsilon);
+            return false;
+        }
+        for(char letter: letters)
+        {
+            auto np=x.next(p, letter), nq=y.next(q, letter);
+            auto rp=find(np), rq=find(x.states+1+nq);
+            if(rp==rq) continue;
+            parent[rq]=rp;
+            pairs.push_back({np, nq, i, letter});
+        }
+    }
+    return true;
+}
+
+/// Antichain check of L(this) ⊆ L(a) on the automata as they are, without determinizing either.
+/// The search runs over pairs (state of this, epsilon-closed set of states of a) reached by the same word;
+/// a pair is dropped when another pair with the same state and a subset of its set has been met, as the latter rejects
+/// at least as many words. A final state paired with a set without final states gives the counterexample.
+bool Automaton::acceptsSubsetOf(const Automaton& a, std::string& counterexample) const
+{
+    if(!states) return true;
+    auto own=epsilonClosures();
+    if(a.states>std::numeric_limits<std::uint32_t>::max()) throw std::length_error("Automaton is too large");
+    struct Item
+    {
+        std::size_t state, subset, from;
+        char letter;
+        bool removed;
+    };
+    SubsetTable subsets;
+    std::vector<std::uint64_t> signature;
+    auto intern=[&](const std::vector<std::uint32_t>& set)
+    {
+        auto id=subsets.intern(set.data(), set.data()+set.size());
+        if(id.second)
+        {
+            std::uint64_t sig=0;
+            for(auto s: set)
+                sig|=std::uint64_t(1)<<(s%64);
+            signature.push_back(sig);
+        }
+        return id.first;
+    };
+    /// sub ⊆ super is first tested on the signatures (the residues modulo 64 of the elements)
+    auto includes=[&](std::size_t super, std::size_t sub)
+    {
+        return !(signature[sub]&~signature[super]) && subsets.end(sub)-subsets.begin(sub)<=subsets.end(super)-subsets.begin(super)
+            && std::includes(subsets.begin(super), subsets.end(super), subsets.begin(sub), subsets.end(sub));
+    };
+    /// Comparisons with the antichain are paid for by the pairs explored and the pairs pruned; when they stop paying off
+    /// (the sets are mostly incomparable), only exact duplicates are dropped, so the search is never much slower than determinization.
+    constexpr std::size_t budget=64;
+    std::size_t scanned=0, pruned=0;
+    std::vector<Item> items;
+    std::vector<std::vector<std::size_t>> antichain(states);
+    std::unordered_set<std::size_t> seen;
+    auto add=[&](std::size_t state, std::size_t subset, std::size_t from, char letter)
+    {
+        if(!seen.insert(subset*states+state).second) return;
+        auto& chain=antichain[state];
+        if(scanned<=budget*(items.size()+budget*pruned))
+        {
+            scanned+=2*chain.size();
+            for(auto i: chain)
+                if(includes(subset, items[i].subset))
+                {
+                    ++pruned;
+                    return;
+                }
+            std::size_t kept=0;
+            for(auto i: chain)
+                if(includes(items[i].subset, subset)) items[i].removed=true;
+                else chain[kept++]=i;
+            chain.resize(kept);
+        }
+        chain.push_back(items.size());
+        items.push_back({state, subset, from, letter, false});
+    };
+    std::vector<std::uint32_t> set;
+    if(a.states) set.assign(a.epsilonClosures()->begin(0), a.epsilonClosures()->end(0));
+    auto start=intern(set);
+    for(auto it=own->begin(0); it!=own->end(0); ++it)
+        add(*it, start, 0, epsilon);
+    std::vector<std::size_t> mark(a.states);
+    std::size_t stamp=0;
+    for(std::size_t i=0; i<items.size(); ++i)
+    {
+        if(items[i].removed) continue;
+        auto state=items[i].state, subset=items[i].subset, target=subset;
+        if(isFinal(state) && !a.containsFinalState(subsets.begin(subset), subsets.end(subset)))
+        {
+            counterexample.clear();
+            for(auto j=i; items[j].letter!=epsilon; j=items[j].from)
+                counterexample.push_back(items[j].letter);
+            std::reverse(counterexample.begin(), counterexample.end());
+            if(counterexample.empty()) counterexample.push_back(epsilon);
+            return false;
+        }
+        for(auto e=transitions.begin(state); e<transitions.end(state); ++e)
+        {
+            char letter=transitions.label(e);
+            if(letter==epsilon) continue;
+            if(e==transitions.begin(state) || transitions.label(e-1)!=letter)
+            {
+                a.successor(subsets.begin(subset), subsets.end(subset), letter, set, mark, stamp);
+                target=intern(set);
+            }
+            for(auto it=own->begin(transitions.target(e)); it!=own->end(transitions.target(e)); ++it)
+                add(*it, target, i, letter);
+        }
+    }
+    return true;
+}
+
+/// Universality over the alphabet of the automaton: the one-state automaton accepting every word is checked for inclusion.
+bool Automaton::acceptsAllWords(std::string& counterexample) const
+{
+    Automaton all;
+    all.states=1;
+    all.alpha=alpha;
+    all.finalStates.insert(0);
+    std::vector<Transition> trans;
+    for(char letter: alpha)
+        trans.emplace_back(0, letter, 0);
+    all.transitions=TransitionTable(1, std::move(trans));
+    return all.acceptsSubsetOf(*this, counterexample);
+}
+
+/// Marks the states reachable from the initial state.
+std::vector<bool> Automaton::reachableStates() const
+{
+    std::vector<bool> res(states);
+    if(!states) return res;
+    std::vector<std::size_t> stack{0};
+    res[0]=true;
+    while(!stack.empty())
+    {
+        auto s=stack.back();
+        stack.pop_back();
+        for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+            if(!res[transitions.target(e)])
+            {
+                res[transitions.target(e)]=true;
+                stack.push_back(transitions.target(e));
+            }
+    }
+    return res;
+}
+
+bool Automaton::acceptsTheEmptyLang() const
+{
+    if(auto known=cached(&Language::empty)) return *known;
+    auto reachable=reachableStates();
+    bool res=std::none_of(finalStates.begin(), finalStates.end(), [&](std::size_t f) {return reachable[f];});
+    cache(&Language::empty, std::optional<bool>(res));
+    return res;
+}
+
+/// Transition table of a deterministic automaton with one row per state and one column per letter, npos where there is no transition.
+std::vector<std::size_t> Automaton::flatTable(const std::vector<char>& letters) const
+{
+    std::vector<std::size_t> res(states*letters.size());
+    for(std::size_t s=0; s<states; ++s)
+        for(std::size_t a=0; a<letters.size(); ++a)
+        {
+            auto t=next(s, letters[a]);
+            res[s*letters.size()+a]=t<states ? t : static_cast<std::size_t>(-1);
+        }
+    return res;
+}
+
+/// Number of accepted words of every length from 0 to maxLength: the number of words leading from the initial state
+/// to every state of the deterministic version is propagated one letter at a time.
+std::vector<Natural> Automaton::countWords(std::size_t maxLength) const
+{
+    Automaton d=*this;
+    d.convertToDFA();
+    std::vector<char> letters(d.alpha.begin(), d.alpha.end());
+    auto delta=d.flatTable(letters);
+    std::size_t k=letters.size();
+    std::vector<Natural> res(maxLength+1), cur(d.states), next(d.states);
+    if(!d.states) return res;
+    cur[0]=1;
+    for(std::size_t length=0; ; ++length)
+    {
+        for(auto f: d.finalStates)
+            res[length]+=cur[f];
+        if(length==maxLength) break;
+        std::fill(next.begin(), next.end(), Natural());
+        for(std::size_t s=0; s<d.states; ++s)
+            if(!cur[s].isZero())
+                for(std::size_t a=0; a<k; ++a)
+                    if(delta[s*k+a]!=static_cast<std::size_t>(-1)) next[delta[s*k+a]]+=cur[s];
+        cur.swap(next);
+    }
+    return res;
+}
+
+/// The enumerator gets the trimmed automaton: states that are not both reachable and co-reachable lose their transitions,
+/// so that it stops for finite languages even when a useless state lies on a cycle.
+WordEnumerator Automaton::words() const
+{
+    Automaton d=*this;
+    d.convertToDFA();
+    std::vector<char> letters(d.alpha.begin(), d.alpha.end());
+    auto delta=d.flatTable(letters);
+    auto useful=d.reachableStates(), coreachable=d.coreachableStates();
+    for(std::size_t s=0; s<d.states; ++s)
+        useful[s]=useful[s] && coreachable[s];
+    for(std::size_t i=0; i<delta.size(); ++i)
+        if(!useful[i/letters.size()] || (delta[i]!=static_cast<std::size_t>(-1) && !useful[delta[i]])) delta[i]=-1;
+    std::vector<bool> accepting(d.states);
+    for(auto f: d.finalStates)
+        accepting[f]=useful[f];
+    return WordEnumerator(std::move(letters), std::move(delta), std::move(accepting), d.states && useful[0] ? 0 : static_cast<std::size_t>(-1));
+}
+
+/// The minimal automaton of the language, reversed if reversed is set; with unanchored, any word over the alphabet may precede its words.
+Automaton Automaton::searchAutomaton(bool reversed, bool unanchored) const
+{
+    Automaton res;
+    res.alpha=alpha;
+    res.states=states+1;
+    res.deterministic=false;
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<Transition> trans(&arena);
+    trans.reserve(transitions.size()+alpha.size()+finalStates.size()+1);
+    if(unanchored)
+        for(char letter: alpha)
+            trans.emplace_back(0, letter, 0);
+    if(reversed)
+    {
+        for(auto f: finalStates)
+            trans.emplace_back(0, epsilon, f+1);
+        for(std::size_t s=0; s<states; ++s)
+            for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+                trans.emplace_back(transitions.target(e)+1, transitions.label(e), s+1);
+        if(states) res.finalStates.insert(1);
+    }
+    else
+    {
+        if(states) trans.emplace_back(0, epsilon, 1);
+        appendTransitions(trans, 1);
+        for(auto f: finalStates)
+            res.finalStates.insert(f+1);
+    }
+    res.transitions=TransitionTable(res.states, trans.data(), trans.data()+trans.size());
+    res.minimize();
+    return res;
+}
+
+TextSearcher Automaton::searcher() const
+{
+    Automaton a=*this;
+    a.minimize();
+    /// the letters that can begin a match; a complete minimal automaton keeps a dead state, which transitions into do not count
+    std::string starters;
+    if(a.states && !a.isFinal(0))
+    {
+        auto live=a.coreachableStates();
+        for(auto e=a.transitions.begin(0); e<a.transitions.end(0); ++e)
+            if(live[a.transitions.target(e)]) starters.push_back(a.transitions.label(e));
+    }
+    if(starters.size()>3) starters.clear();
+    auto compiled=[](const Automaton& x) {return CompiledDFA(x.transitions, x.alpha, x.finalStates);};
+    return TextSearcher(compiled(searchAutomaton(false, true)), compiled(a), compiled(searchAutomaton(true, true)), std::move(starters));
+}
+
+/// The language is infinite exactly when some state that is both reachable and co-reachable lies on a cycle reading a letter,
+/// i.e. when a non-epsilon transition joins two such states of the same strongly connected component.
+bool Automaton::acceptsFiniteLang() const
+{
+    if(auto known=cached(&Language::finite)) return *known;
+    auto useful=reachableStates(), coreachable=coreachableStates();
+    for(std::size_t s=0; s<states; ++s)
+        useful[s]=useful[s] && coreachable[s];
+    std::size_t components;
+    auto component=transitions.stronglyConnectedComponents(useful, [this](std::size_t s)
+    {
+        return std::make_pair(transitions.begin(s), transitions.end(s));
+    }, components);
+    for(std::size_t s=0; s<states; ++s)
+        if(useful[s])
+            for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+                if(transitions.label(e)!=epsilon && useful[transitions.target(e)] && component[transitions.target(e)]==component[s])
+                {
+                    cache(&Language::finite, std::optional<bool>(false));
+                    return false;
+                }
+    cache(&Language::finite, std::optional<bool>(true));
+    return true;
+}
+
+/// Writes the minimal DFA as a C++ header (see DfaMatcher::writeHeader) so that the matcher can be compiled into a program.
+bool Automaton::saveHeader(const std::string& path, const std::string& name) const
+{
+    Automaton d=*this;
+    d.minimize();
+    std::ofstream ofs(path);
+    if(!ofs) return false;
+    if(SmallMatcher<std::uint8_t>::fits(d.states, d.alpha.size()))
+        SmallMatcher<std::uint8_t>(d.transitions, d.alpha, d.finalStates, epsilon).writeHeader(ofs, name);
+    else if(SmallMatcher<std::uint16_t>::fits(d.states, d.alpha.size()))
+        SmallMatcher<std::uint16_t>(d.transitions, d.alpha, d.finalStates, epsilon).writeHeader(ofs, name);
+    else throw std::length_error("Automaton is too large to be generated");
+    return bool(ofs);
+}
+
+/// The automaton is written to a temporary file that then replaces the target: after a binary load the transitions
+/// may be mapped from the target itself, which must not be truncated while they are read.
+bool Automaton::save(const std::string& path, Format format) const
+{
+    auto temporary=path+".tmp";
+    {
+        std::ofstream ofs(temporary, format==Format::binary ? std::ios::binary : std::ios::out);
+        if(!ofs) return false;
+        if(format==Format::text) ofs << *this;
+        else writeBinary(ofs);
+        ofs.close();
+        if(!ofs)
+        {
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if(!std::rename(temporary.c_str(), path.c_str())) return true;
+#ifdef _WIN32
+    /// rename does not replace an existing file here; once the target is gone, the temporary holds the only copy and is kept
+    if(!std::remove(path.c_str())) return !std::rename(temporary.c_str(), path.c_str());
+#endif
+    std::remove(temporary.c_str());
+    return false;
+}
+
+void Automaton::writeBinary(std::ostream& ofs) const
+{
+    BinaryHeader h{};
+    std::copy(binaryMagic, binaryMagic+4, h.magic);
+    h.version=binaryVersion;
+    h.byteOrder=binaryByteOrder;
+    h.states=states;
+    h.edges=transitions.size();
+    for(auto c: alpha)
+        h.alphabet[static_cast<unsigned char>(c)/64]|=std::uint64_t(1)<<(static_cast<unsigned char>(c)%64);
+    std::vector<std::uint64_t> bits(bitmapWords(states));
+    for(auto f: finalStates)
+        bits[f/64]|=std::uint64_t(1)<<(f%64);
+    ofs.write(reinterpret_cast<const char*>(&h), sizeof h);
+    ofs.write(reinterpret_cast<const char*>(bits.data()), bits.size()*8);
+    if(sizeof(std::size_t)==sizeof(std::uint64_t))
+    {
+        ofs.write(reinterpret_cast<const char*>(transitions.offsetData()), (states+1)*8);
+        ofs.write(reinterpret_cast<const char*>(transitions.targetData()), transitions.size()*8);
+    }
+    else
+    {
+        std::vector<std::uint64_t> offsets(states+1), targets(transitions.size());
+        for(std::size_t s=0; s<states; ++s)
+            offsets[s+1]=transitions.end(s);
+        for(std::size_t e=0; e<transitions.size(); ++e)
+            targets[e]=transitions.target(e);
+        ofs.write(reinterpret_cast<const char*>(offsets.data()), offsets.size()*8);
+        ofs.write(reinterpret_cast<const char*>(targets.data()), targets.size()*8);
+    }
+    ofs.write(transitions.labelData(), transitions.size());
+}
+
+bool Automaton::containsFinalState(const std::uint32_t* first, const std::uint32_t* last) const
+{
+    for(; first!=last; ++first)
+        if(isFinal(*first)) return true;
+    return false;
+}
+
+void Automaton::successor(const std::uint32_t* first, const std::uint32_t* last, char letter, std::vector<std::uint32_t>& res,
+                          std::vector<std::size_t>& mark, std::size_t& stamp) const
+{
+    const auto& closures=*epsilonClosures();
+    res.clear();
+    ++stamp;
+    for(; first!=last; ++first)
+        for(auto e=transitions.lowerBound(*first, letter); e<transitions.upperBound(*first, letter); ++e)
+            if(mark[transitions.target(e)]!=stamp)
+                for(auto it=closures.begin(transitions.target(e)); it!=closures.end(transitions.target(e)); ++it)
+                    if(mark[*it]!=stamp)
+                    {
+                        mark[*it]=stamp;
+                        res.push_back(*it);
+                    }
+    std::sort(res.begin(), res.end());
+}
+
+/// A deterministic automaton of the language that is already known is taken as it is, and the complete one
+/// of a union of such automata is their product. Otherwise subsets are expanded in batches: the successors of every subset
+/// in a batch are computed in parallel, then interned in order of subset and letter, so the numbering does not depend
+/// on the number of threads. Scratch data comes from an arena, except for the buffers the worker threads fill and grow.
+Automaton& Automaton::convertToDFA(unsigned threads)
+{
+    if(deterministic) return *this;
+    auto lang=language;
+    std::shared_ptr<const Automaton> known;
+    std::vector<std::shared_ptr<const Automaton>> parts;
+    {
+        std::lock_guard<std::mutex> guard(lang->mutex);
+        known=lang->dfa;
+        parts=lang->parts;
+    }
+    if(known)
+    {
+        *this=*known;
+        language=lang;
+        return *this;
+    }
+    if(!parts.empty())
+    {
+        Automaton res=*parts[0];
+        for(std::size_t i=1; i<parts.size(); ++i)
+            res=res.product(*parts[i], [](bool x, bool y) {return x || y;});
+        *this=std::move(res);
+        language=lang;
+        cache(&Language::dfa, snapshot());
+        return *this;
+    }
+    if(states>std::numeric_limits<std::uint32_t>::max()) throw std::length_error("Automaton is too large to be determinized");
+    auto closures=epsilonClosures();
+    if(!threads) threads=1;
+    constexpr std::size_t batch=1024, chunk=16;
+    std::pmr::monotonic_buffer_resource arena;
+    std::pmr::vector<char> letters(alpha.begin(), alpha.end(), &arena);
+    std::size_t k=letters.size();
+    SubsetTable subsets;
+    std::pmr::vector<std::uint32_t> start(closures->begin(0), closures->end(0), &arena);
+    subsets.intern(start.data(), start.data()+start.size());
+    std::vector<std::vector<std::uint32_t>> succ;
+    std::pmr::vector<std::uint64_t> hashes(&arena);
+    std::vector<std::vector<std::size_t>> marks(threads, std::vector<std::size_t>(states));
+    std::pmr::vector<std::size_t> stamps(threads, &arena);
+    std::pmr::vector<Transition> trans(&arena);
+    std::set<std::size_t> fin;
+    for(std::size_t lo=0; lo<subsets.size();)
+    {
+        std::size_t hi=std::min(subsets.size(), lo+batch*threads);
+        succ.resize(std::max(succ.size(), (hi-lo)*k));
+        hashes.resize(succ.size());
+        std::atomic<std::size_t> next(lo);
+        auto expand=[&](unsigned worker)
+        {
+            for(std::size_t from; (from=next.fetch_add(chunk))<hi;)
+                for(auto id=from; id<std::min(hi, from+chunk); ++id)
+                    for(std::size_t a=0; a<k; ++a)
+                    {
+                        auto& n=succ[(id-lo)*k+a];
+                        successor(subsets.begin(id), subsets.end(id), letters[a], n, marks[worker], stamps[worker]);
+                        hashes[(id-lo)*k+a]=SubsetTable::hash(n.data(), n.data()+n.size());
+                    }
+        };
+        std::vector<std::thread> workers;
+        for(unsigned w=1; w<threads && (w-1)*chunk<hi-lo; ++w)
+            workers.emplace_back(expand, w);
+        expand(0);
+        for(auto& w: workers)
+            w.join();
+        for(auto id=lo; id<hi; ++id)
+        {
+            if(containsFinalState(subsets.begin(id), subsets.end(id))) fin.insert(fin.end(), id);
+            for(std::size_t a=0; a<k; ++a)
+            {
+                const auto& n=succ[(id-lo)*k+a];
+                trans.emplace_back(id, letters[a], subsets.intern(n.data(), n.data()+n.size(), hashes[(id-lo)*k+a]).first);
+            }
+        }
+        lo=hi;
+    }
+    states=subsets.size();
+    transitions=TransitionTable(states, trans.data(), trans.data()+trans.size());
+    finalStates=std::move(fin);
+    deterministic=true;
+    discardCompiled();
+    cache(&Language::dfa, snapshot());
+    return *this;
+}
+
+void Automaton::removeUnreachableStates(std::pmr::memory_resource* arena)
+{
+    if(!states) return;
+    std::pmr::vector<bool> f(states, false, arena);
+    std::pmr::vector<std::size_t> q(1, 0, arena);
+    f[0]=true;
+    for(std::size_t i=0; i<q.size(); ++i)
+        for(auto e=transitions.begin(q[i]); e<transitions.end(q[i]); ++e)
+            if(!f[transitions.target(e)])
+            {
+                f[transitions.target(e)]=true;
+                q.push_back(transitions.target(e));
+            }
+    std::pmr::vector<std::size_t> newIndex(states, arena);
+    std::size_t c=0;
+    for(std::size_t i=0; i<states; ++i)
+        if(f[i]) newIndex[i]=c++;
+    if(c==states) return;
+    std::pmr::vector<Transition> trans(arena);
+    trans.reserve(transitions.size());
+    for(std::size_t s=0; s<states; ++s)
+        if(f[s])
+            for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+                trans.emplace_back(newIndex[s], transitions.label(e), newIndex[transitions.target(e)]);
+    std::set<std::size_t> fin;
+    for(auto s: finalStates)
+        if(f[s]) fin.insert(fin.end(), newIndex[s]);
+    states=c;
+    transitions=TransitionTable(states, trans.data(), trans.data()+trans.size());
+    finalStates=std::move(fin);
+    discardCompiled();
+}
+
+/// Hopcroft's partition refinement on a deterministic automaton whose states are all reachable. Missing transitions lead to
+/// an implicit dead state, which gets the index states in the result (only if there is one). Returns the class of every state;
+/// classes are numbered in breadth-first order from the initial state, following the letters in alphabetical order,
+/// so the numbering depends only on the language.
+std::pmr::vector<std::size_t> Automaton::equivalenceClasses(std::size_t& classes, std::pmr::memory_resource* arena) const
+{
+    static constexpr std::size_t npos=-1;
+    std::size_t k=alpha.size(), n=states, dead=states;
+    std::pmr::vector<std::size_t> delta(n*k, dead, arena);
+    {
+        std::size_t a=0;
+        for(char letter: alpha)
+        {
+            for(std::size_t s=0; s<states; ++s)
+            {
+                auto e=transitions.lowerBound(s, letter);
+                if(e<transitions.end(s) && transitions.label(e)==letter) delta[s*k+a]=transitions.target(e);
+                else if(n==states) ++n;
+            }
+            ++a;
+        }
+    }
+    if(n>states) delta.resize(n*k, dead);
+    /// incoming transitions grouped by (letter, target)
+    std::pmr::vector<std::size_t> inOffsets(k*n+1, arena), inSources(n*k, arena);
+    for(std::size_t s=0; s<n; ++s)
+        for(std::size_t a=0; a<k; ++a)
+            ++inOffsets[a*n+delta[s*k+a]+1];
+    for(std::size_t i=0; i<k*n; ++i)
+        inOffsets[i+1]+=inOffsets[i];
+    {
+        std::pmr::vector<std::size_t> pos(inOffsets, arena);
+        for(std::size_t s=0; s<n; ++s)
+            for(std::size_t a=0; a<k; ++a)
+                inSources[pos[a*n+delta[s*k+a]]++]=s;
+    }
+    /// the states of block b are elements[first[b], last[b]); the marked ones come first
+    std::pmr::vector<std::size_t> elements(n, arena), location(n, arena), block(n, arena), first(arena), last(arena), marked(arena);
+    std::size_t finals=0;
+    for(std::size_t s=0; s<states; ++s)
+        if(isFinal(s)) elements[finals++]=s;
+    for(std::size_t s=0, c=finals; s<n; ++s)
+        if(s>=states || !isFinal(s)) elements[c++]=s;
+    for(std::size_t i=0; i<n; ++i)
+    {
+        location[elements[i]]=i;
+        block[elements[i]]=i>=finals;
+    }
+    first={0, finals};
+    last={finals, n};
+    marked={0, 0};
+    if(!finals || finals==n)
+    {
+        first.pop_back();
+        last.front()=n;
+        marked.pop_back();
+        for(auto& b: block) b=0;
+    }
+    std::pmr::vector<std::pair<std::size_t, std::size_t>> work(arena);
+    std::pmr::vector<bool> inWork(first.size()*k, false, arena);
+    auto smaller=last.size()==2 && last[0]-first[0]>last[1]-first[1];
+    for(std::size_t a=0; a<k; ++a)
+    {
+        work.emplace_back(smaller, a);
+        inWork[smaller*k+a]=true;
+    }
+    std::pmr::vector<std::size_t> splitter(arena), touched(arena);
+    while(!work.empty())
+    {
+        auto b=work.back().first, a=work.back().second;
+        work.pop_back();
+        inWork[b*k+a]=false;
+        splitter.assign(elements.begin()+first[b], elements.begin()+last[b]);
+        for(auto t: splitter)
+            for(auto i=inOffsets[a*n+t]; i<inOffsets[a*n+t+1]; ++i)
+            {
+                auto s=inSources[i], c=block[s];
+                if(location[s]<first[c]+marked[c]) continue;
+                if(!marked[c]) touched.push_back(c);
+                auto j=first[c]+marked[c]++, other=elements[j];
+                elements[location[s]]=other;
+                location[other]=location[s];
+                elements[j]=s;
+                location[s]=j;
+            }
+        for(auto c: touched)
+        {
+            auto m=marked[c];
+            marked[c]=0;
+            if(m==last[c]-first[c]) continue;
+            std::size_t nb=first.size();
+            first.push_back(first[c]);
+            last.push_back(first[c]+m);
+            marked.push_back(0);
+            first[c]+=m;
+            for(auto i=first[nb]; i<last[nb]; ++i)
+                block[elements[i]]=nb;
+            inWork.resize(first.size()*k);
+            for(std::size_t l=0; l<k; ++l)
+            {
+                std::size_t add=inWork[c*k+l] || last[nb]-first[nb]<=last[c]-first[c] ? nb : c;
+                if(inWork[add*k+l]) continue;
+                inWork[add*k+l]=true;
+                work.emplace_back(add, l);
+            }
+        }
+        touched.clear();
+    }
+    std::pmr::vector<std::size_t> res(n, npos, arena), number(first.size(), npos, arena), queue(1, 0, arena);
+    number[block[0]]=0;
+    classes=1;
+    for(std::size_t i=0; i<queue.size(); ++i)
+        for(std::size_t a=0; a<k; ++a)
+        {
+            auto t=delta[queue[i]*k+a];
+            if(number[block[t]]!=npos) continue;
+            number[block[t]]=classes++;
+            queue.push_back(t);
+        }
+    for(std::size_t s=0; s<n; ++s)
+        res[s]=number[block[s]];
+    return res;
+}
+
+/// The minimal automaton is cached next to the deterministic one, which convertToDFA keeps serving, so that the result
+/// of determinization does not depend on whether some copy was minimized before.
+Automaton& Automaton::minimize()
+{
+    auto lang=language;
+    if(auto known=cached(&Language::minimal))
+    {
+        *this=*known;
+        language=lang;
+        return *this;
+    }
+    convertToDFA();
+    std::pmr::monotonic_buffer_resource arena;
+    removeUnreachableStates(&arena);
+    if(finalStates.empty())
+    {
+        *this=Automaton();
+        language=lang;
+    }
+    else
+    {
+        std::size_t classes;
+        auto cl=equivalenceClasses(classes, &arena);
+        /// the result is complete: a class that the implicit dead state belongs to is kept like any other
+        std::size_t dead=cl.size()>states ? cl[states] : static_cast<std::size_t>(-1);
+        std::pmr::vector<Transition> trans(&arena);
+        trans.reserve(classes*alpha.size());
+        std::set<std::size_t> fin;
+        std::pmr::vector<bool> done(classes, false, &arena);
+        for(std::size_t s=0; s<cl.size(); ++s)
+        {
+            if(done[cl[s]]) continue;
+            done[cl[s]]=true;
+            if(isFinal(s)) fin.insert(cl[s]);
+            for(char letter: alpha)
+            {
+                auto t=next(s, letter);
+                trans.emplace_back(cl[s], letter, t<states ? cl[t] : dead);
+            }
+        }
+        states=classes;
+        transitions=TransitionTable(states, trans.data(), trans.data()+trans.size());
+        finalStates=std::move(fin);
+        discardCompiled();
+    }
+    std::lock_guard<std::mutex> guard(lang->mutex);
+    lang->minimal=snapshot();
+    lang->empty=!states;
+    return *this;
+}
+
+std::ostream& operator<<(std::ostream& os, const Automaton& a)
+{
+    TextWriter out(os);
+    out << a.states << ' ' << a.finalStates.size() << '\n';
+    auto it=a.finalStates.begin();
+    if(it!=a.finalStates.end())
+    {
+        out << *it;
+        while(++it!=a.finalStates.end())
+            out << ' ' << *it;
+        out << '\n';
+    }
+    out << a.transitions.size() << '\n';
+    for(std::size_t s=0; s<a.states; ++s)
+        for(auto e=a.transitions.begin(s); e<a.transitions.end(s); ++e)
+            out << s << ' ' << a.transitions.label(e) << ' ' << a.transitions.target(e) << '\n';
+    return os;
+}
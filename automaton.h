@@ -1,43 +1,127 @@
-#ifndef AUTOMATON_H
-#define AUTOMATON_H
-#include <set>
-#include <cstddef>
-#include <iosfwd>
-#include <string>
-#include "transition.h"
-
-class Automaton
-{
-    std::size_t states=0;
-    std::set<Transition> transitions;
-    std::set<char> alpha;
-    std::set<std::size_t> finalStates;
-    bool deterministic=true;
-    Automaton() = default;
-    bool traverse(const char*, std::size_t, std::set<std::pair<const char*, std::size_t>>&) const;
-    bool traverse(const char*) const;
-    bool isFinal(std::size_t) const;
-    bool isDeterm() const;
-    void addReachableThroughEps(std::set<std::size_t>&) const;
-    void removeUnreachableStates();
-    bool containsFinalState(const std::set<std::size_t>&) const;
-    bool isFinalStateReachable(std::size_t) const;
-    bool existPathWithNonzeroLength(std::size_t, std::size_t) const;
-    friend class RegularExpression;
-public:
-    static constexpr char epsilon='E';
-    bool isDeterministic() const;
-    Automaton(std::istream&);
-    bool operator()(const std::string&) const;
-    Automaton Union(const Automaton&) const;
-    Automaton Concatenation(const Automaton&) const;
-    Automaton KleeneStar() const;
-    bool acceptsTheEmptyLang() const;
-    bool acceptsFiniteLang() const;
-    bool save(const std::string&) const;
-    Automaton& convertToDFA();
-    Automaton& minimize();
-    friend std::ostream& operator<<(std::ostream&, const Automaton&);
-};
-
-#endif // AUTOMATON_H
+#ifndef AUTOMATON_H
+#define AUTOMATON_H
+#include <set>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+#include "transition.h"
+#include "transitionTable.h"
+#include "compiledDFA.h"
+#include "dfaMatcher.h"
+#include "epsilonClosure.h"
+#include "nfaSimulator.h"
+#include "lazyDFA.h"
+#include "streamMatcher.h"
+#include "natural.h"
+#include "wordEnumerator.h"
+#include "textSearcher.h"
+
+class MappedFile;
+
+class Automaton
+{
+    std::size_t states=0;
+    TransitionTable transitions;
+    std::set<char> alpha;
+    std::set<std::size_t> finalStates;
+    bool deterministic=true;
+    /// as many letters as regular expressions can use: a-z and 0-9
+    template<typename StateT>
+    using SmallMatcher=DfaMatcher<StateT, 36>;
+    /// Everything built from the transitions; it is built on first use and shared by the copies of the automaton
+    /// until the automaton changes.
+    struct Matchers
+    {
+        std::once_flag built, closed;
+        std::shared_ptr<const CompiledDFA> matcher;
+        std::shared_ptr<const SmallMatcher<std::uint8_t>> matcher8;
+        std::shared_ptr<const SmallMatcher<std::uint16_t>> matcher16;
+        std::shared_ptr<const EpsilonClosure> closures;
+        std::shared_ptr<const NFASimulator> simulator;
+        std::shared_ptr<LazyDFA> lazy;
+    };
+    /// What is known about the language; it survives determinization and minimization.
+    /// parts are deterministic automata whose union is the language, when a union was formed of automata whose
+    /// deterministic versions were at hand; the deterministic version is then their product instead of the subset construction.
+    struct Language
+    {
+        std::mutex mutex;
+        std::optional<bool> empty, finite;
+        std::shared_ptr<const Automaton> dfa, minimal;
+        std::vector<std::shared_ptr<const Automaton>> parts;
+    };
+    std::shared_ptr<Matchers> compiled=std::make_shared<Matchers>();
+    std::shared_ptr<Language> language=std::make_shared<Language>();
+    Automaton() = default;
+    void read(const char*, const char*);
+    void read(std::shared_ptr<const MappedFile>);
+    void writeBinary(std::ostream&) const;
+    const Matchers& matchers() const;
+    const std::shared_ptr<const EpsilonClosure>& epsilonClosures() const;
+    void discardCompiled();
+    template<typename T>
+    T cached(T Language::*) const;
+    template<typename T>
+    void cache(T Language::*, const T&) const;
+    std::shared_ptr<const Automaton> snapshot() const;
+    std::vector<std::shared_ptr<const Automaton>> unionParts() const;
+    bool traverse(const char*) const;
+    bool isFinal(std::size_t) const;
+    bool isDeterm() const;
+    void removeUnreachableStates(std::pmr::memory_resource*);
+    void appendTransitions(std::pmr::vector<Transition>&, std::size_t) const;
+    bool containsFinalState(const std::uint32_t*, const std::uint32_t*) const;
+    void successor(const std::uint32_t*, const std::uint32_t*, char, std::vector<std::uint32_t>&, std::vector<std::size_t>&, std::size_t&) const;
+    std::size_t next(std::size_t, char) const;
+    std::vector<bool> coreachableStates() const;
+    std::vector<std::size_t> flatTable(const std::vector<char>&) const;
+    Automaton product(const Automaton&, bool (*)(bool, bool)) const;
+    std::vector<bool> reachableStates() const;
+    std::pmr::vector<std::size_t> equivalenceClasses(std::size_t&, std::pmr::memory_resource*) const;
+    Automaton searchAutomaton(bool, bool) const;
+    friend class RegularExpression;
+    friend class PatternSet;
+public:
+    static constexpr char epsilon='E';
+    enum class Format {text, binary};
+    bool isDeterministic() const;
+    Automaton(std::istream&);
+    explicit Automaton(const std::string&);
+    bool operator()(const std::string&) const;
+    StreamMatcher stream() const;
+    bool recognize(std::istream&) const;
+    std::size_t recognizeLines(const char*, std::size_t, std::size_t&, unsigned=1) const;
+    Automaton Union(const Automaton&) const&;
+    Automaton Union(const Automaton&) &&;
+    Automaton Concatenation(const Automaton&) const&;
+    Automaton Concatenation(const Automaton&) &&;
+    Automaton KleeneStar() const&;
+    Automaton KleeneStar() &&;
+    Automaton& uniteWith(const Automaton&);
+    Automaton& concatenateWith(const Automaton&);
+    Automaton& applyKleeneStar();
+    Automaton Intersection(const Automaton&) const;
+    Automaton Difference(const Automaton&) const;
+    Automaton Complement() const;
+    bool acceptsTheEmptyLang() const;
+    bool acceptsFiniteLang() const;
+    bool acceptsTheSameLang(const Automaton&, std::string&) const;
+    bool acceptsSubsetOf(const Automaton&, std::string&) const;
+    bool acceptsAllWords(std::string&) const;
+    std::vector<Natural> countWords(std::size_t) const;
+    WordEnumerator words() const;
+    TextSearcher searcher() const;
+    bool save(const std::string&, Format=Format::text) const;
+    bool saveHeader(const std::string&, const std::string&) const;
+    Automaton& convertToDFA(unsigned=1);
+    Automaton& minimize();
+    friend std::ostream& operator<<(std::ostream&, const Automaton&);
+};
+
+#endif // AUTOMATON_H
@@ -0,0 +1,335 @@
+#include "compiledDFA.h"
+#include "automaton.h"
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <cstring>
+#ifdef COMPILEDDFA_AVX2
+#include <immintrin.h>
+#endif
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    constexpr std::size_t lanes=8;
+
+    /// The position of the first of the given bytes (at most 3 of them) in text[from, length), length if there is none.
+    std::size_t findAny(const char* text, std::size_t from, std::size_t length, const std::string& bytes) noexcept
+    {
+        if(bytes.size()==1)
+        {
+            auto p=static_cast<const char*>(std::memchr(text+from, bytes[0], length-from));
+            return p ? p-text : length;
+        }
+#ifdef __SSE2__
+        const __m128i a=_mm_set1_epi8(bytes[0]), b=_mm_set1_epi8(bytes[1]), c=_mm_set1_epi8(bytes.back());
+        for(; from+16<=length; from+=16)
+        {
+            __m128i v=_mm_loadu_si128(reinterpret_cast<const __m128i*>(text+from));
+            int found=_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, a), _mm_cmpeq_epi8(v, b)), _mm_cmpeq_epi8(v, c)));
+            if(found) return from+__builtin_ctz(found);
+        }
+#endif
+        for(; from<length; ++from)
+            if(bytes.find(text[from])!=std::string::npos) return from;
+        return length;
+    }
+}
+
+CompiledDFA::CompiledDFA(const TransitionTable& transitions, const std::set<char>& alpha, const std::set<std::size_t>& finalStates)
+{
+    std::size_t states=transitions.states();
+    std::vector<std::vector<std::size_t>> columns;
+    for(char letter: alpha)
+    {
+        std::vector<std::size_t> column(states, states);
+        for(std::size_t s=0; s<states; ++s)
+        {
+            auto e=transitions.lowerBound(s, letter);
+            if(e<transitions.end(s) && transitions.label(e)==letter) column[s]=transitions.target(e);
+        }
+        columns.push_back(std::move(column));
+    }
+    /// states from which no final state is reachable behave like the dead state, so they are merged into it
+    std::vector<std::vector<std::size_t>> sources(states);
+    for(auto&& column: columns)
+        for(std::size_t s=0; s<states; ++s)
+            if(column[s]<states) sources[column[s]].push_back(s);
+    std::vector<bool> live(states, false);
+    std::vector<std::size_t> pending(finalStates.begin(), finalStates.end());
+    for(auto f: pending)
+        live[f]=true;
+    while(!pending.empty())
+    {
+        std::size_t t=pending.back();
+        pending.pop_back();
+        for(auto s: sources[t])
+            if(!live[s])
+            {
+                live[s]=true;
+                pending.push_back(s);
+            }
+    }
+    for(auto&& column: columns)
+        for(auto& t: column)
+            if(t<states && !live[t]) t=states;
+    /// class 0: bytes outside the alphabet, class 1: the epsilon symbol, which is skipped
+    std::map<std::vector<std::size_t>, std::uint16_t> classIndex;
+    std::fill(std::begin(classOf), std::end(classOf), 0);
+    classOf[static_cast<unsigned char>(Automaton::epsilon)]=1;
+    classes=2;
+    auto column=columns.begin();
+    for(char letter: alpha)
+    {
+        auto p=classIndex.emplace(std::move(*column++), classes);
+        if(p.second) ++classes;
+        classOf[static_cast<unsigned char>(letter)]=p.first->second;
+    }
+    if((states+1)*classes>std::numeric_limits<std::uint32_t>::max())
+        throw std::length_error("Automaton is too large to be compiled");
+    next.resize((states+1)*classes);
+    accepting.resize(next.size());
+    dead=states*classes;
+    start=states && live[0] ? 0 : dead;
+    for(std::size_t s=0; s<=states; ++s)
+    {
+        next[s*classes]=dead;
+        next[s*classes+1]=s*classes;
+    }
+    for(auto&& cl: classIndex)
+        for(std::size_t s=0; s<states; ++s)
+            next[s*classes+cl.second]=cl.first[s]*classes;
+    for(std::size_t c=0; c<classes; ++c)
+        next[dead+c]=dead;
+    for(auto f: finalStates)
+        accepting[f*classes]=true;
+}
+
+std::uint32_t CompiledDFA::initial() const noexcept
+{
+    return start;
+}
+
+/// Advances the given state over the input; stops early once the dead state is reached.
+std::uint32_t CompiledDFA::run(std::uint32_t state, const char* word, std::size_t length) const noexcept
+{
+    constexpr std::size_t block=64;
+    const std::uint32_t* table=next.data();
+    for(std::size_t i=0; i<length && state!=dead; i+=block)
+    {
+        std::size_t last=std::min(length, i+block);
+        for(std::size_t j=i; j<last; ++j)
+            state=table[state+classOf[static_cast<unsigned char>(word[j])]];
+    }
+    return state;
+}
+
+bool CompiledDFA::isDead(std::uint32_t state) const noexcept
+{
+    return state==dead;
+}
+
+bool CompiledDFA::accepts(std::uint32_t state) const noexcept
+{
+    return accepting[state];
+}
+
+bool CompiledDFA::operator()(const char* word, std::size_t length) const
+{
+    return accepts(run(start, word, length));
+}
+
+/// The length of the longest accepted prefix of the input, npos if no prefix is accepted.
+std::size_t CompiledDFA::longestPrefix(const char* text, std::size_t length) const noexcept
+{
+    auto state=start;
+    std::size_t res=accepting[state] ? 0 : npos;
+    for(std::size_t i=0; i<length && state!=dead;)
+        if(accepting[state=next[state+classOf[static_cast<unsigned char>(text[i++])]]]) res=i;
+    return res;
+}
+
+/// Advances the state over the input until it accepts and returns the number of bytes consumed (the whole input if it never accepts).
+/// This is meant for the automaton of a language closed under adding prefixes (as \Sigma^*L): the dead state, which only bytes outside
+/// the alphabet lead to, is left for the start state, and in the start state the input is skipped up to the next of the given bytes.
+/// These have to include every letter that leaves the start state; with none given nothing is skipped.
+std::size_t CompiledDFA::findAccepting(std::uint32_t& state, const char* text, std::size_t length, const std::string& starters) const noexcept
+{
+    for(std::size_t i=0; i<length;)
+    {
+        if(state==start && !starters.empty() && (i=findAny(text, i, length, starters))==length) break;
+        state=next[state+classOf[static_cast<unsigned char>(text[i++])]];
+        if(state==dead) state=start;
+        if(accepting[state]) return i;
+    }
+    return length;
+}
+
+/// Reads the whole input backwards like findAccepting and sets marks[i] to whether the state accepts once text[i] has been read
+/// (marks[length] for the start state).
+void CompiledDFA::markAcceptingSuffixes(const char* text, std::size_t length, std::vector<bool>& marks) const
+{
+    marks.assign(length+1, false);
+    auto state=start;
+    marks[length]=accepting[state];
+    for(std::size_t i=length; i--;)
+    {
+        state=next[state+classOf[static_cast<unsigned char>(text[i])]];
+        if(state==dead) state=start;
+        marks[i]=accepting[state];
+    }
+}
+
+/// For every position where an accepted word of the text ends, the leftmost position where one ending there starts,
+/// as (start, end) pairs in increasing order of end. The runs from all start positions are followed together; runs that reach
+/// the same state accept the same continuations, so they are merged into the leftmost one and at most one run per state is alive.
+/// While no run is alive, the input is skipped up to the next of the given bytes, as in findAccepting.
+std::vector<std::pair<std::size_t, std::size_t>> CompiledDFA::longestMatches(const char* text, std::size_t length, const std::string& starters) const
+{
+    std::vector<std::pair<std::size_t, std::size_t>> res;
+    /// the live runs as (state, start) in increasing order of start; seen[s] is the last position where state s had a run
+    std::vector<std::pair<std::uint32_t, std::size_t>> runs, moved;
+    std::vector<std::size_t> seen(next.size()/classes, npos);
+    for(std::size_t i=0; ; ++i)
+    {
+        if(runs.empty() && !starters.empty()) i=findAny(text, i, length, starters);
+        if(start!=dead && seen[start/classes]!=i)
+        {
+            seen[start/classes]=i;
+            runs.emplace_back(start, i);
+        }
+        for(auto& r: runs)
+            if(accepting[r.first])
+            {
+                res.emplace_back(r.second, i);
+                break;
+            }
+        if(i==length) return res;
+        moved.clear();
+        auto c=classOf[static_cast<unsigned char>(text[i])];
+        for(auto& r: runs)
+        {
+            auto state=next[r.first+c];
+            if(state==dead || seen[state/classes]==i+1) continue;
+            seen[state/classes]=i+1;
+            moved.emplace_back(state, r.second);
+        }
+        runs.swap(moved);
+    }
+}
+
+/// Tests many words of one buffer, word i being [offsets[i], offsets[i]+lengths[i]), and returns how many are accepted.
+/// A single word is a chain of dependent table loads; here 8 words advance side by side so that their loads overlap,
+/// with AVX2 gathers where the processor has them. A lane that finishes its word (or reaches the dead state) takes the next one.
+std::size_t CompiledDFA::countAccepted(const char* base, std::size_t size, const std::uint32_t* offsets, const std::uint32_t* lengths,
+                                       std::size_t count) const
+{
+#ifdef COMPILEDDFA_AVX2
+    constexpr std::size_t limit=std::numeric_limits<std::int32_t>::max();
+    if(size>=4 && size<=limit && next.size()<=limit && __builtin_cpu_supports("avx2")) return countAcceptedAVX2(base, offsets, lengths, count);
+#endif
+    static_cast<void>(size);
+    return countAcceptedScalar(base, offsets, lengths, count);
+}
+
+std::size_t CompiledDFA::countAcceptedScalar(const char* base, const std::uint32_t* offsets, const std::uint32_t* lengths, std::size_t count) const
+{
+    std::uint32_t state[lanes], position[lanes], end[lanes];
+    bool active[lanes];
+    std::size_t word=0, res=0, running=0;
+    auto refill=[&](std::size_t l)
+    {
+        for(; word<count; ++word)
+            if(lengths[word]) break;
+            else res+=accepts(start);
+        active[l]=word<count;
+        if(!active[l]) return;
+        state[l]=start;
+        position[l]=offsets[word];
+        end[l]=offsets[word]+lengths[word];
+        ++word;
+        ++running;
+    };
+    for(std::size_t l=0; l<lanes; ++l)
+        refill(l);
+    const std::uint32_t* table=next.data();
+    while(running)
+        for(std::size_t l=0; l<lanes; ++l)
+        {
+            if(!active[l]) continue;
+            state[l]=table[state[l]+classOf[static_cast<unsigned char>(base[position[l]++])]];
+            if(position[l]==end[l] || state[l]==dead)
+            {
+                res+=accepts(state[l]);
+                --running;
+                refill(l);
+            }
+        }
+    return res;
+}
+
+#ifdef COMPILEDDFA_AVX2
+/// The input bytes are gathered too: 4 bytes are loaded ending at the wanted one (or starting at the buffer, for the first 3 bytes)
+/// and shifted, so no load leaves the buffer.
+__attribute__((target("avx2")))
+std::size_t CompiledDFA::countAcceptedAVX2(const char* base, const std::uint32_t* offsets, const std::uint32_t* lengths, std::size_t count) const
+{
+    alignas(32) std::uint32_t state[lanes], position[lanes], end[lanes], active[lanes];
+    std::size_t word=0, res=0, running=0;
+    auto refill=[&](std::size_t l)
+    {
+        for(; word<count; ++word)
+            if(lengths[word]) break;
+            else res+=accepts(start);
+        active[l]=word<count ? ~0u : 0;
+        state[l]=start;
+        position[l]=word<count ? offsets[word] : 0;
+        end[l]=word<count ? offsets[word]+lengths[word] : 0;
+        if(word<count)
+        {
+            ++word;
+            ++running;
+        }
+    };
+    for(std::size_t l=0; l<lanes; ++l)
+        refill(l);
+    const __m256i three=_mm256_set1_epi32(3), byteMask=_mm256_set1_epi32(0xFF), deadState=_mm256_set1_epi32(dead);
+    const int* classes=reinterpret_cast<const int*>(classOf);
+    const int* table=reinterpret_cast<const int*>(next.data());
+    while(running)
+    {
+        __m256i s=_mm256_load_si256(reinterpret_cast<const __m256i*>(state));
+        __m256i pos=_mm256_load_si256(reinterpret_cast<const __m256i*>(position));
+        __m256i last=_mm256_load_si256(reinterpret_cast<const __m256i*>(end));
+        __m256i live=_mm256_load_si256(reinterpret_cast<const __m256i*>(active));
+        int done;
+        do
+        {
+            __m256i back=_mm256_min_epu32(pos, three);
+            __m256i chunk=_mm256_i32gather_epi32(reinterpret_cast<const int*>(base), _mm256_sub_epi32(pos, back), 1);
+            __m256i byte=_mm256_and_si256(_mm256_srlv_epi32(chunk, _mm256_slli_epi32(back, 3)), byteMask);
+            __m256i cls=_mm256_i32gather_epi32(classes, byte, 4);
+            __m256i t=_mm256_i32gather_epi32(table, _mm256_add_epi32(s, cls), 4);
+            s=_mm256_blendv_epi8(s, t, live);
+            pos=_mm256_sub_epi32(pos, live);
+            __m256i finished=_mm256_or_si256(_mm256_cmpeq_epi32(pos, last), _mm256_cmpeq_epi32(s, deadState));
+            done=_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_and_si256(finished, live)));
+        }
+        while(!done);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(state), s);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(position), pos);
+        for(std::size_t l=0; l<lanes; ++l)
+            if(done>>l&1)
+            {
+                res+=accepts(state[l]);
+                --running;
+                refill(l);
+            }
+    }
+    return res;
+}
+#endif
@@ -0,0 +1,45 @@
+#ifndef COMPILEDDFA_H
+#define COMPILEDDFA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "transitionTable.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define COMPILEDDFA_AVX2
+#endif
+
+/// Table-driven matcher for a deterministic automaton.
+/// Input bytes are collapsed into equivalence classes and the next state is stored premultiplied by the number of classes,
+/// so that every input byte costs a single table load. Whether a state accepts is also indexed by the premultiplied state.
+class CompiledDFA
+{
+    std::uint32_t classOf[256];
+    std::size_t classes;
+    std::vector<std::uint32_t> next;
+    std::vector<bool> accepting;
+    std::uint32_t start, dead;
+    std::size_t countAcceptedScalar(const char*, const std::uint32_t*, const std::uint32_t*, std::size_t) const;
+#ifdef COMPILEDDFA_AVX2
+    std::size_t countAcceptedAVX2(const char*, const std::uint32_t*, const std::uint32_t*, std::size_t) const;
+#endif
+public:
+    static constexpr std::size_t npos=-1;
+    CompiledDFA(const TransitionTable&, const std::set<char>&, const std::set<std::size_t>&);
+    std::uint32_t initial() const noexcept;
+    std::uint32_t run(std::uint32_t, const char*, std::size_t) const noexcept;
+    bool isDead(std::uint32_t) const noexcept;
+    bool accepts(std::uint32_t) const noexcept;
+    bool operator()(const char*, std::size_t) const;
+    std::size_t countAccepted(const char*, std::size_t, const std::uint32_t*, const std::uint32_t*, std::size_t) const;
+    std::size_t longestPrefix(const char*, std::size_t) const noexcept;
+    std::size_t findAccepting(std::uint32_t&, const char*, std::size_t, const std::string&) const noexcept;
+    void markAcceptingSuffixes(const char*, std::size_t, std::vector<bool>&) const;
+    std::vector<std::pair<std::size_t, std::size_t>> longestMatches(const char*, std::size_t, const std::string&) const;
+};
+
+#endif // COMPILEDDFA_H
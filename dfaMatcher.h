@@ -0,0 +1,102 @@
+#ifndef DFAMATCHER_H
+#define DFAMATCHER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <ostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "transitionTable.h"
+
+/// Table-driven matcher for small deterministic automata: at most AlphabetSize letters and fewer states than StateT can count.
+/// Every row has the same compile-time width, AlphabetSize+2 columns: column 0 for bytes outside the alphabet (to the dead state),
+/// column 1 for the epsilon symbol (to the state itself), then one column per letter in increasing order.
+/// With StateT=std::uint8_t and 36 letters (a-z, 0-9, as in regular expressions) the whole table stays under 10 KiB.
+template<typename StateT, std::size_t AlphabetSize>
+class DfaMatcher
+{
+    static_assert(std::is_unsigned<StateT>::value, "States must be stored in an unsigned type");
+    static_assert(AlphabetSize+2<=std::numeric_limits<std::uint8_t>::max(), "Symbols are stored in bytes");
+    static constexpr std::size_t columns=AlphabetSize+2;
+    std::uint8_t symbolOf[256];
+    std::vector<StateT> next;
+    std::vector<bool> accepting;
+    StateT start, dead;
+public:
+    static bool fits(std::size_t states, std::size_t letters) noexcept
+    {
+        return letters<=AlphabetSize && states<std::numeric_limits<StateT>::max();
+    }
+
+    DfaMatcher(const TransitionTable& transitions, const std::set<char>& alpha, const std::set<std::size_t>& finalStates, char epsilon)
+    {
+        std::size_t states=transitions.states();
+        if(!fits(states, alpha.size())) throw std::length_error("Automaton is too large for this matcher");
+        std::fill(symbolOf, symbolOf+256, 0);
+        symbolOf[static_cast<unsigned char>(epsilon)]=1;
+        std::uint8_t symbol=2;
+        for(char letter: alpha)
+            symbolOf[static_cast<unsigned char>(letter)]=symbol++;
+        dead=states;
+        start=states ? 0 : dead;
+        next.assign((states+1)*columns, dead);
+        accepting.resize(states+1);
+        for(std::size_t s=0; s<=states; ++s)
+            next[s*columns+1]=s;
+        for(std::size_t s=0; s<states; ++s)
+            for(auto e=transitions.begin(s); e<transitions.end(s); ++e)
+                if(transitions.label(e)!=epsilon) next[s*columns+symbolOf[static_cast<unsigned char>(transitions.label(e))]]=transitions.target(e);
+        for(auto f: finalStates)
+            accepting[f]=true;
+    }
+
+    bool operator()(const char* word, std::size_t length) const noexcept
+    {
+        constexpr std::size_t block=64;
+        const StateT* table=next.data();
+        std::size_t state=start;
+        for(std::size_t i=0; i<length && state!=dead; i+=block)
+        {
+            std::size_t last=std::min(length, i+block);
+            for(std::size_t j=i; j<last; ++j)
+                state=table[state*columns+symbolOf[static_cast<unsigned char>(word[j])]];
+        }
+        return accepting[state];
+    }
+
+    /// Writes a self-contained header with the tables as constexpr arrays and a constexpr matching function in namespace name.
+    void writeHeader(std::ostream& os, const std::string& name) const
+    {
+        const char* type=sizeof(StateT)==1 ? "std::uint8_t" : sizeof(StateT)==2 ? "std::uint16_t" : "std::uint32_t";
+        std::size_t rows=accepting.size();
+        os << "// Generated matcher: " << rows-1 << " states, state " << +dead << " is the dead state\n";
+        os << "#pragma once\n#include <cstddef>\n#include <cstdint>\n\nnamespace " << name << "\n{\n";
+        os << "    constexpr std::uint8_t symbolOf[256]={";
+        for(std::size_t c=0; c<256; ++c)
+            os << (c ? "," : "") << (c%32 ? "" : "\n        ") << +symbolOf[c];
+        os << "\n    };\n    constexpr " << type << " next[" << rows << "][" << columns << "]={";
+        for(std::size_t s=0; s<rows; ++s)
+        {
+            os << (s ? "," : "") << "\n        {";
+            for(std::size_t c=0; c<columns; ++c)
+                os << (c ? "," : "") << +next[s*columns+c];
+            os << '}';
+        }
+        os << "\n    };\n    constexpr bool accepting[" << rows << "]={";
+        for(std::size_t s=0; s<rows; ++s)
+            os << (s ? "," : "") << (s%32 ? "" : "\n        ") << accepting[s];
+        os << "\n    };\n";
+        os << "    constexpr bool matches(const char* word, std::size_t length)\n    {\n";
+        os << "        std::size_t state=" << +start << ";\n";
+        os << "        for(std::size_t i=0; i<length && state!=" << +dead << "; ++i)\n";
+        os << "            state=next[state][symbolOf[static_cast<unsigned char>(word[i])]];\n";
+        os << "        return accepting[state];\n    }\n}\n";
+    }
+};
+
+#endif // DFAMATCHER_H
@@ -0,0 +1,64 @@
+#include "epsilonClosure.h"
+#include "automaton.h"
+#include <algorithm>
+#include <utility>
+
+EpsilonClosure::EpsilonClosure(const TransitionTable& transitions)
+{
+    std::size_t states=transitions.states(), components;
+    /// the components of the epsilon graph
+    component=transitions.stronglyConnectedComponents(std::vector<bool>(states, true), [&](std::size_t s)
+    {
+        return std::make_pair(transitions.lowerBound(s, Automaton::epsilon), transitions.upperBound(s, Automaton::epsilon));
+    }, components);
+    offsets.assign(components+1, 0);
+    std::vector<std::size_t> byComponent(states), first(components+1);
+    for(std::size_t s=0; s<states; ++s)
+        ++first[component[s]+1];
+    for(std::size_t c=0; c<components; ++c)
+        first[c+1]+=first[c];
+    {
+        auto pos=first;
+        for(std::size_t s=0; s<states; ++s)
+            byComponent[pos[component[s]]++]=s;
+    }
+    /// successors are completed before their predecessors, so each closure is the union of the component itself
+    /// and of the already computed closures of the components it has epsilon transitions to
+    std::vector<std::size_t> mark(states, components);
+    for(std::size_t c=0; c<components; ++c)
+    {
+        std::size_t from=members.size();
+        for(auto i=first[c]; i<first[c+1]; ++i)
+        {
+            mark[byComponent[i]]=c;
+            members.push_back(byComponent[i]);
+        }
+        for(auto i=first[c]; i<first[c+1]; ++i)
+        {
+            auto v=byComponent[i];
+            for(auto e=transitions.lowerBound(v, Automaton::epsilon); e<transitions.upperBound(v, Automaton::epsilon); ++e)
+            {
+                auto d=component[transitions.target(e)];
+                if(d==c || mark[transitions.target(e)]==c) continue;
+                for(auto j=offsets[d]; j<offsets[d+1]; ++j)
+                    if(mark[members[j]]!=c)
+                    {
+                        mark[members[j]]=c;
+                        members.push_back(members[j]);
+                    }
+            }
+        }
+        std::sort(members.begin()+from, members.end());
+        offsets[c+1]=members.size();
+    }
+}
+
+const std::size_t* EpsilonClosure::begin(std::size_t state) const noexcept
+{
+    return members.data()+offsets[component[state]];
+}
+
+const std::size_t* EpsilonClosure::end(std::size_t state) const noexcept
+{
+    return members.data()+offsets[component[state]+1];
+}
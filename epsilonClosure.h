@@ -0,0 +1,20 @@
+#ifndef EPSILONCLOSURE_H
+#define EPSILONCLOSURE_H
+
+#include <cstddef>
+#include <vector>
+#include "transitionTable.h"
+
+/// The states reachable from every state through epsilon transitions only (the state itself included), in increasing order.
+/// States on a common epsilon cycle have the same closure, so closures are computed and stored once per strongly connected
+/// component of the epsilon graph: the closure of s occupies [begin(s), end(s)).
+class EpsilonClosure
+{
+    std::vector<std::size_t> component, offsets, members;
+public:
+    EpsilonClosure(const TransitionTable&);
+    const std::size_t* begin(std::size_t) const noexcept;
+    const std::size_t* end(std::size_t) const noexcept;
+};
+
+#endif // EPSILONCLOSURE_H
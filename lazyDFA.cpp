@@ -0,0 +1,102 @@
+#include "lazyDFA.h"
+#include <utility>
+
+LazyDFA::LazyDFA(const TransitionTable& transitions, std::shared_ptr<const EpsilonClosure> closures, std::shared_ptr<const NFASimulator> fallback,
+                 const std::set<char>& alpha, const std::set<std::size_t>& finalStates, std::size_t budget):
+    fallback(std::move(fallback)), states(transitions.states()), finalState(states), cache(transitions, std::move(closures), alpha, budget)
+{
+    for(auto f: finalStates)
+        finalState[f]=true;
+}
+
+std::size_t LazyDFA::intern(const std::vector<std::uint32_t>& subset)
+{
+    auto p=cache.intern(subset);
+    if(!p.second) return p.first;
+    bool acc=false;
+    for(auto s: subset)
+        acc=acc || finalState[s];
+    accepting.push_back(acc);
+    return p.first;
+}
+
+void LazyDFA::flush()
+{
+    cache.flush();
+    accepting.clear();
+    start=unknown;
+}
+
+void LazyDFA::fallBack()
+{
+    active.assign((states+63)/64, 0);
+    for(auto it=cache.begin(current); it!=cache.end(current); ++it)
+        active[*it/64]|=std::uint64_t(1)<<*it%64;
+    simulating=true;
+}
+
+void LazyDFA::reset()
+{
+    if(start==unknown && states) start=intern(cache.initial());
+    current=start;
+    simulating=false;
+    flushes=consumed=lastFlush=0;
+}
+
+bool LazyDFA::feed(const char* word, std::size_t length)
+{
+    if(simulating) return fallback->run(active, word, length);
+    if(current==unknown || cache.isDead(current)) return false;
+    for(std::size_t i=0; i<length; ++i, ++consumed)
+    {
+        auto l=cache.letter(word[i]);
+        if(l==1) continue;
+        if(!l)
+        {
+            current=intern({});
+            return false;
+        }
+        auto cached=cache.transition(current, l-2);
+        if(cached!=unknown)
+        {
+            current=cached;
+            continue;
+        }
+        auto subset=cache.successor(current, l-2);
+        if(!cache.fits(subset))
+        {
+            /// give up on caching if the cache does not survive long enough to pay off
+            if(++flushes>=3 && consumed-lastFlush<10*accepting.size())
+            {
+                current=intern(subset);
+                if(cache.isDead(current)) return false;
+                fallBack();
+                return fallback->run(active, word+i+1, length-i-1);
+            }
+            flush();
+            lastFlush=consumed;
+            current=intern(subset);
+        }
+        else
+        {
+            auto target=intern(subset);
+            cache.link(current, l-2, target);
+            current=target;
+        }
+        if(cache.isDead(current)) return false;
+    }
+    return true;
+}
+
+bool LazyDFA::accepts() const
+{
+    if(simulating) return fallback->accepts(active);
+    return current!=unknown && accepting[current];
+}
+
+bool LazyDFA::operator()(const char* word, std::size_t length)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    reset();
+    return feed(word, length) && accepts();
+}
@@ -0,0 +1,46 @@
+#ifndef LAZYDFA_H
+#define LAZYDFA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include "transitionTable.h"
+#include "epsilonClosure.h"
+#include "nfaSimulator.h"
+#include "subsetCache.h"
+
+/// On-the-fly subset construction for a nondeterministic automaton.
+/// DFA states (epsilon-closed sets of automaton states) and their transitions are created only when the input needs them
+/// and are kept in a cache. When the cache grows beyond its memory budget it is flushed and construction restarts
+/// from the current state; if flushes happen faster than the input is consumed, matching falls back to the bit-parallel simulation.
+/// reset, feed and accepts match input incrementally and are not synchronized; operator() matches a whole word under a lock.
+class LazyDFA
+{
+    static constexpr std::size_t unknown=SubsetCache::unknown;
+    std::shared_ptr<const NFASimulator> fallback;
+    std::size_t states;
+    std::vector<bool> finalState;
+    SubsetCache cache;
+    std::vector<bool> accepting;
+    std::size_t start=unknown, current=unknown;
+    std::size_t flushes=0, consumed=0, lastFlush=0;
+    bool simulating=false;
+    std::vector<std::uint64_t> active;
+    std::mutex mutex;
+    std::size_t intern(const std::vector<std::uint32_t>&);
+    void flush();
+    void fallBack();
+public:
+    static constexpr std::size_t defaultBudget=std::size_t(8)<<20;
+    LazyDFA(const TransitionTable&, std::shared_ptr<const EpsilonClosure>, std::shared_ptr<const NFASimulator>,
+            const std::set<char>&, const std::set<std::size_t>&, std::size_t=defaultBudget);
+    void reset();
+    bool feed(const char*, std::size_t);
+    bool accepts() const;
+    bool operator()(const char*, std::size_t);
+};
+
+#endif // LAZYDFA_H
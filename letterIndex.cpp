@@ -0,0 +1,12 @@
+#include "letterIndex.h"
+#include "automaton.h"
+#include <algorithm>
+#include <iterator>
+
+LetterIndex::LetterIndex(const std::vector<char>& letters)
+{
+    std::fill(std::begin(number), std::end(number), 0);
+    number[static_cast<unsigned char>(Automaton::epsilon)]=1;
+    for(std::size_t i=0; i<letters.size(); ++i)
+        number[static_cast<unsigned char>(letters[i])]=i+2;
+}
@@ -0,0 +1,21 @@
+#ifndef LETTERINDEX_H
+#define LETTERINDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Numbers the characters of the input for the matchers that simulate an automaton with epsilon transitions:
+/// 0 stands for a character outside the alphabet, 1 for the epsilon symbol, which is skipped, and i+2 for the i-th letter.
+class LetterIndex
+{
+    std::uint16_t number[256];
+public:
+    explicit LetterIndex(const std::vector<char>&);
+    std::size_t operator()(char c) const noexcept
+    {
+        return number[static_cast<unsigned char>(c)];
+    }
+};
+
+#endif // LETTERINDEX_H
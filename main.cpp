@@ -1,126 +1,275 @@
-#include <iostream>
-#include <fstream>
-#include <algorithm>
-#include <stdexcept>
-#include <vector>
-#include <string>
-#include <cctype>
-#include <iomanip>
-#include "Automaton.h"
-#include "regularExpression.h"
-using namespace std;
-
-std::string toLower(std::string s)
-{
-    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {return std::tolower(c);});
-    return s;
-}
-
-int main()
-{
-    std::string command, text;
-    std::vector<Automaton> v;
-    std::size_t id, id2;
-    std::cout << std::boolalpha;
-    while(std::cin) try
-    {
-        std::cin >> command;
-        command=toLower(command);
-        if(command=="open")
-        {
-            std::cin >> text;
-            std::ifstream is(text);
-            if(!is) std::cout << "Could not open file " << std::quoted(text) << std::endl;
-            else
-            {
-                v.emplace_back(is);
-                std::cout << "File " << std::quoted(text) << " loaded successfully\n";
-                std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
-            }
-        }
-        else if(command=="list")
-        {
-            if(!v.empty()) std::cout << 0;
-            for(std::size_t i=1; i<v.size(); ++i)
-                std::cout << ' ' << i;
-            std::cout << std::endl;
-        }
-        else if(command=="print")
-        {
-            std::cin >> id;
-            std::cout << v.at(id) << std::endl;
-        }
-        else if(command=="save")
-        {
-            std::cin >> id >> text;
-            if(v.at(id).save(text)) std::cout << "Success\n";
-            else std::cout << "Could not open file " << std::quoted(text) << std::endl;
-        }
-        else if(command=="empty")
-        {
-            std::cin >> id;
-            std::cout << v.at(id).acceptsTheEmptyLang() << std::endl;
-        }
-        else if(command=="deterministic")
-        {
-            std::cin >> id;
-            std::cout << v.at(id).isDeterministic() << std::endl;
-        }
-        else if(command=="recognize")
-        {
-            std::cin >> id >> text;
-            std::cout << v.at(id)(text) << std::endl;
-        }
-        else if(command=="union")
-        {
-            std::cin >> id >> id2;
-            v.push_back(v.at(id).Union(v.at(id2)));
-            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
-        }
-        else if(command=="concat")
-        {
-            std::cin >> id >> id2;
-            v.push_back(v.at(id).Concatenation(v.at(id2)));
-            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
-        }
-        else if(command=="un")
-        {
-            std::cin >> id;
-            v.push_back(v.at(id).KleeneStar());
-            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
-        }
-        else if(command=="reg")
-        {
-            std::cin >> text;
-            RegularExpression reg(text);
-            v.push_back(reg.NFA());
-            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
-        }
-        else if(command=="dfa")
-        {
-            std::cin >> id;
-            v.at(id).convertToDFA();
-            std::cout << "Success\n";
-        }
-        else if(command=="finite")
-        {
-            std::cin >> id;
-            std::cout << v.at(id).acceptsFiniteLang() << std::endl;
-        }
-        else if(command=="min")
-        {
-            std::cin >> id;
-            v.at(id).minimize();
-            std::cout << "Success\n";
-        }
-        else if(command=="exit")
-            return 0;
-        else
-            std::cout << "Invalid command\n";
-    }
-    catch(const std::exception& e)
-    {
-        std::cerr << e.what() << std::endl;
-        return 0;
-    }
-}
+#include <iostream>
+#include <fstream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <string>
+#include <cctype>
+#include <iomanip>
+#include <memory>
+#include <thread>
+#include "Automaton.h"
+#include "regularExpression.h"
+#include "regexCache.h"
+#include "mappedFile.h"
+#include "patternSet.h"
+using namespace std;
+
+std::string toLower(std::string s)
+{
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {return std::tolower(c);});
+    return s;
+}
+
+int main()
+{
+    std::string command, text;
+    std::vector<Automaton> v;
+    std::unique_ptr<PatternSet> patterns;
+    std::size_t id, id2;
+    std::cout << std::boolalpha;
+    while(std::cin) try
+    {
+        std::cin >> command;
+        command=toLower(command);
+        if(command=="open")
+        {
+            std::cin >> text;
+            if(!std::ifstream(text)) std::cout << "Could not open file " << std::quoted(text) << std::endl;
+            else
+            {
+                v.emplace_back(text);
+                std::cout << "File " << std::quoted(text) << " loaded successfully\n";
+                std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+            }
+        }
+        else if(command=="list")
+        {
+            if(!v.empty()) std::cout << 0;
+            for(std::size_t i=1; i<v.size(); ++i)
+                std::cout << ' ' << i;
+            std::cout << std::endl;
+        }
+        else if(command=="print")
+        {
+            std::cin >> id;
+            std::cout << v.at(id) << std::endl;
+        }
+        else if(command=="save")
+        {
+            std::cin >> id >> text;
+            if(v.at(id).save(text)) std::cout << "Success\n";
+            else std::cout << "Could not open file " << std::quoted(text) << std::endl;
+        }
+        else if(command=="export")
+        {
+            /// the binary format, which open maps into memory instead of parsing; save writes the text format
+            std::cin >> id >> text;
+            if(v.at(id).save(text, Automaton::Format::binary)) std::cout << "Success\n";
+            else std::cout << "Could not open file " << std::quoted(text) << std::endl;
+        }
+        else if(command=="codegen")
+        {
+            std::string name;
+            std::cin >> id >> name >> text;
+            if(v.at(id).saveHeader(text, name)) std::cout << "Success\n";
+            else std::cout << "Could not open file " << std::quoted(text) << std::endl;
+        }
+        else if(command=="empty")
+        {
+            std::cin >> id;
+            std::cout << v.at(id).acceptsTheEmptyLang() << std::endl;
+        }
+        else if(command=="deterministic")
+        {
+            std::cin >> id;
+            std::cout << v.at(id).isDeterministic() << std::endl;
+        }
+        else if(command=="recognize")
+        {
+            std::cin >> id >> text;
+            std::cout << v.at(id)(text) << std::endl;
+        }
+        else if(command=="recognize-file")
+        {
+            std::cin >> id >> text;
+            if(text=="-") std::cout << v.at(id).recognize(std::cin) << std::endl;
+            else
+            {
+                std::ifstream is(text, std::ios::binary);
+                if(!is) std::cout << "Could not open file " << std::quoted(text) << std::endl;
+                else std::cout << v.at(id).recognize(is) << std::endl;
+            }
+        }
+        else if(command=="recognize-batch")
+        {
+            std::cin >> id >> text;
+            std::unique_ptr<MappedFile> file;
+            try
+            {
+                file=std::make_unique<MappedFile>(text);
+            }
+            catch(const std::runtime_error&)
+            {
+                std::cout << "Could not open file " << std::quoted(text) << std::endl;
+                continue;
+            }
+            std::size_t lines;
+            std::size_t accepted=v.at(id).recognizeLines(file->data(), file->size(), lines, std::max(1u, std::thread::hardware_concurrency()));
+            std::cout << accepted << " of " << lines << " words recognized\n";
+        }
+        else if(command=="classify")
+        {
+            std::cin >> text;
+            /// automata are never changed in a way that alters their language, so the set is only rebuilt when new ones appear
+            if(!patterns || patterns->size()!=v.size()) patterns=std::make_unique<PatternSet>(v);
+            auto matches=(*patterns)(text);
+            if(matches.empty()) std::cout << "none";
+            for(std::size_t i=0; i<matches.size(); ++i)
+                std::cout << (i ? " " : "") << matches[i];
+            std::cout << std::endl;
+        }
+        else if(command=="search" || command=="search-all")
+        {
+            std::cin >> id >> text;
+            std::unique_ptr<MappedFile> file;
+            try
+            {
+                file=std::make_unique<MappedFile>(text);
+            }
+            catch(const std::runtime_error&)
+            {
+                std::cout << "Could not open file " << std::quoted(text) << std::endl;
+                continue;
+            }
+            auto mode=command=="search" ? TextSearcher::Mode::leftmostLongest : TextSearcher::Mode::all;
+            auto matches=v.at(id).searcher()(file->data(), file->size(), mode);
+            for(auto&& m: matches)
+                std::cout << m.first << ' ' << m.second << '\n';
+            std::cout << matches.size() << " matches found\n";
+        }
+        else if(command=="union")
+        {
+            std::cin >> id >> id2;
+            v.push_back(v.at(id).Union(v.at(id2)));
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="concat")
+        {
+            std::cin >> id >> id2;
+            v.push_back(v.at(id).Concatenation(v.at(id2)));
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="un")
+        {
+            std::cin >> id;
+            v.push_back(v.at(id).KleeneStar());
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="intersection")
+        {
+            std::cin >> id >> id2;
+            v.push_back(v.at(id).Intersection(v.at(id2)));
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="difference")
+        {
+            std::cin >> id >> id2;
+            v.push_back(v.at(id).Difference(v.at(id2)));
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="complement")
+        {
+            std::cin >> id;
+            v.push_back(v.at(id).Complement());
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="equivalent")
+        {
+            std::cin >> id >> id2;
+            if(v.at(id).acceptsTheSameLang(v.at(id2), text)) std::cout << "true\n";
+            else std::cout << "false: " << text << " is accepted by only one of them\n";
+        }
+        else if(command=="subset")
+        {
+            std::cin >> id >> id2;
+            if(v.at(id).acceptsSubsetOf(v.at(id2), text)) std::cout << "true\n";
+            else std::cout << "false: " << text << " is accepted only by #" << id << '\n';
+        }
+        else if(command=="universal")
+        {
+            std::cin >> id;
+            if(v.at(id).acceptsAllWords(text)) std::cout << "true\n";
+            else std::cout << "false: " << text << " is not accepted\n";
+        }
+        else if(command=="reg")
+        {
+            std::cin >> text;
+            RegularExpression reg(text);
+            v.push_back(reg.NFA());
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="reg-dfa")
+        {
+            std::cin >> text;
+            v.push_back(RegexCache::global().get(text));
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="reg-glushkov")
+        {
+            std::cin >> text;
+            RegularExpression reg(text);
+            v.push_back(reg.NFA(RegularExpression::Construction::glushkov));
+            std::cout << "Automaton #" << v.size()-1 << " created successfully\n";
+        }
+        else if(command=="dfa")
+        {
+            std::cin >> id;
+            v.at(id).convertToDFA();
+            std::cout << "Success\n";
+        }
+        else if(command=="dfa-parallel")
+        {
+            unsigned threads;
+            std::cin >> id >> threads;
+            v.at(id).convertToDFA(threads);
+            std::cout << "Success\n";
+        }
+        else if(command=="finite")
+        {
+            std::cin >> id;
+            std::cout << v.at(id).acceptsFiniteLang() << std::endl;
+        }
+        else if(command=="count")
+        {
+            std::size_t length;
+            std::cin >> id >> length;
+            auto counts=v.at(id).countWords(length);
+            for(std::size_t i=0; i<counts.size(); ++i)
+                std::cout << i << ": " << counts[i] << '\n';
+        }
+        else if(command=="words")
+        {
+            std::size_t count;
+            std::cin >> id >> count;
+            auto words=v.at(id).words();
+            while(count-- && words.next(text))
+                std::cout << (text.empty() ? std::string(1, Automaton::epsilon) : text) << '\n';
+        }
+        else if(command=="min")
+        {
+            std::cin >> id;
+            v.at(id).minimize();
+            std::cout << "Success\n";
+        }
+        else if(command=="exit")
+            return 0;
+        else
+            std::cout << "Invalid command\n";
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 0;
+    }
+}
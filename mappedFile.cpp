@@ -0,0 +1,61 @@
+#include "mappedFile.h"
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPEDFILE_MMAP
+#endif
+
+MappedFile::MappedFile(const std::string& path)
+{
+#ifdef MAPPEDFILE_MMAP
+    int fd=::open(path.c_str(), O_RDONLY);
+    if(fd<0) throw std::runtime_error("Could not open file \""+path+"\"");
+    struct stat st;
+    if(::fstat(fd, &st)<0)
+    {
+        ::close(fd);
+        throw std::runtime_error("Could not read from the file");
+    }
+    length=st.st_size;
+    if(length)
+    {
+        void* p=::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(p==MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error("Could not read from the file");
+        }
+        ::madvise(p, length, MADV_SEQUENTIAL);
+        bytes=static_cast<const char*>(p);
+    }
+    ::close(fd);
+#else
+    std::ifstream is(path, std::ios::binary);
+    if(!is) throw std::runtime_error("Could not open file \""+path+"\"");
+    buffer.assign(std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>());
+    bytes=buffer.data();
+    length=buffer.size();
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef MAPPEDFILE_MMAP
+    if(length) ::munmap(const_cast<char*>(bytes), length);
+#endif
+}
+
+const char* MappedFile::data() const noexcept
+{
+    return bytes;
+}
+
+std::size_t MappedFile::size() const noexcept
+{
+    return length;
+}
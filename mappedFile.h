@@ -0,0 +1,23 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/// Read-only view of a whole file. The file is memory-mapped where the platform supports it and read into memory otherwise.
+class MappedFile
+{
+    const char* bytes=nullptr;
+    std::size_t length=0;
+    std::vector<char> buffer;
+public:
+    explicit MappedFile(const std::string&);
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile();
+    const char* data() const noexcept;
+    std::size_t size() const noexcept;
+};
+
+#endif // MAPPEDFILE_H
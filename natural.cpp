@@ -0,0 +1,46 @@
+#include "natural.h"
+#include <algorithm>
+#include <ostream>
+
+Natural::Natural(std::uint64_t n)
+{
+    for(; n; n/=base)
+        digits.push_back(n%base);
+}
+
+bool Natural::isZero() const noexcept
+{
+    return digits.empty();
+}
+
+Natural& Natural::operator+=(const Natural& n)
+{
+    if(digits.size()<n.digits.size()) digits.resize(n.digits.size());
+    std::uint32_t carry=0;
+    for(std::size_t i=0; i<digits.size() && (carry || i<n.digits.size()); ++i)
+    {
+        digits[i]+=carry+(i<n.digits.size() ? n.digits[i] : 0);
+        carry=digits[i]>=base;
+        if(carry) digits[i]-=base;
+    }
+    if(carry) digits.push_back(carry);
+    return *this;
+}
+
+std::string Natural::toString() const
+{
+    if(digits.empty()) return "0";
+    std::string res=std::to_string(digits.back());
+    for(auto i=digits.size()-1; i--;)
+    {
+        auto part=std::to_string(digits[i]);
+        res.append(9-part.size(), '0');
+        res+=part;
+    }
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& os, const Natural& n)
+{
+    return os << n.toString();
+}
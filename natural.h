@@ -0,0 +1,23 @@
+#ifndef NATURAL_H
+#define NATURAL_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/// Arbitrary-precision non-negative integer supporting what word counting needs: addition and decimal output.
+class Natural
+{
+    static constexpr std::uint32_t base=1000000000;
+    std::vector<std::uint32_t> digits; /// in base 10^9, least significant first, no leading zeros
+public:
+    Natural() = default;
+    Natural(std::uint64_t);
+    bool isZero() const noexcept;
+    Natural& operator+=(const Natural&);
+    std::string toString() const;
+    friend std::ostream& operator<<(std::ostream&, const Natural&);
+};
+
+#endif // NATURAL_H
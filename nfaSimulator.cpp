@@ -0,0 +1,112 @@
+#include "nfaSimulator.h"
+#include <algorithm>
+#include <utility>
+
+NFASimulator::NFASimulator(const TransitionTable& transitions, std::shared_ptr<const EpsilonClosure> closures, const std::set<char>& alpha, const std::set<std::size_t>& finalStates):
+    transitions(transitions), closures(std::move(closures)), letters(alpha.begin(), alpha.end()), letterOf(letters), states(transitions.states()), words((states+63)/64),
+    start(words), accepting(words)
+{
+    if(states) addClosure(0, start);
+    for(auto f: finalStates)
+        accepting[f/64]|=std::uint64_t(1)<<f%64;
+    if(states>smallLimit) return;
+    nibbleMasks.resize(letters.size()*256);
+    for(std::size_t l=0; l<letters.size(); ++l)
+    {
+        std::uint64_t* table=&nibbleMasks[l*256];
+        for(std::size_t s=0; s<states; ++s)
+        {
+            std::vector<std::uint64_t> succ(1);
+            for(auto e=transitions.lowerBound(s, letters[l]); e<transitions.upperBound(s, letters[l]); ++e)
+                addClosure(transitions.target(e), succ);
+            for(std::size_t nibble=0; nibble<16; ++nibble)
+                if(nibble>>s%4 & 1) table[s/4*16+nibble]|=succ[0];
+        }
+    }
+}
+
+void NFASimulator::addClosure(std::size_t state, std::vector<std::uint64_t>& set) const
+{
+    for(auto it=closures->begin(state); it!=closures->end(state); ++it)
+        set[*it/64]|=std::uint64_t(1)<<*it%64;
+}
+
+bool NFASimulator::runSmall(std::uint64_t& active, const char* word, std::size_t length) const
+{
+    std::size_t nibbles=(states+3)/4;
+    for(std::size_t i=0; i<length; ++i)
+    {
+        auto l=letterOf(word[i]);
+        if(l==1) continue;
+        if(!l)
+        {
+            active=0;
+            return false;
+        }
+        const std::uint64_t* table=&nibbleMasks[(l-2)*256];
+        std::uint64_t next=0;
+        for(std::size_t k=0; k<nibbles; ++k)
+            next|=table[k*16+(active>>4*k & 15)];
+        if(!(active=next)) return false;
+    }
+    return true;
+}
+
+bool NFASimulator::runLarge(std::vector<std::uint64_t>& active, const char* word, std::size_t length) const
+{
+    std::vector<std::uint64_t> next(words);
+    for(std::size_t i=0; i<length; ++i)
+    {
+        auto l=letterOf(word[i]);
+        if(l==1) continue;
+        if(!l)
+        {
+            std::fill(active.begin(), active.end(), 0);
+            return false;
+        }
+        char letter=letters[l-2];
+        std::fill(next.begin(), next.end(), 0);
+        bool any=false;
+        for(std::size_t w=0; w<words; ++w)
+            for(auto bits=active[w]; bits; bits&=bits-1)
+            {
+                std::size_t s=w*64+__builtin_ctzll(bits);
+                for(auto e=transitions.lowerBound(s, letter); e<transitions.upperBound(s, letter); ++e)
+                {
+                    auto t=transitions.target(e);
+                    if(next[t/64]>>t%64 & 1) continue;
+                    addClosure(t, next);
+                    any=true;
+                }
+            }
+        active.swap(next);
+        if(!any) return false;
+    }
+    return true;
+}
+
+const std::vector<std::uint64_t>& NFASimulator::initial() const noexcept
+{
+    return start;
+}
+
+/// Continues the simulation from the given (epsilon-closed) set of active states.
+/// Returns false as soon as no state is active, since then no continuation of the input can be accepted.
+bool NFASimulator::run(std::vector<std::uint64_t>& active, const char* word, std::size_t length) const
+{
+    if(!states) return false;
+    return states<=smallLimit ? runSmall(active[0], word, length) : runLarge(active, word, length);
+}
+
+bool NFASimulator::accepts(const std::vector<std::uint64_t>& active) const noexcept
+{
+    for(std::size_t w=0; w<words; ++w)
+        if(active[w] & accepting[w]) return true;
+    return false;
+}
+
+bool NFASimulator::operator()(const char* word, std::size_t length) const
+{
+    auto active=start;
+    return run(active, word, length) && accepts(active);
+}
@@ -0,0 +1,38 @@
+#ifndef NFASIMULATOR_H
+#define NFASIMULATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <vector>
+#include "transitionTable.h"
+#include "epsilonClosure.h"
+#include "letterIndex.h"
+
+/// Thompson-style simulation of a nondeterministic automaton.
+/// The set of active states is kept as a bitset and is closed under epsilon transitions after every step.
+/// Automata with at most 64 states are simulated in a single machine word:
+/// for every letter and every nibble of the active set a precomputed successor mask is OR-ed in (a generalized shift-and).
+class NFASimulator
+{
+    static constexpr std::size_t smallLimit=64;
+    TransitionTable transitions;
+    std::shared_ptr<const EpsilonClosure> closures;
+    std::vector<char> letters;
+    LetterIndex letterOf;
+    std::size_t states, words;
+    std::vector<std::uint64_t> start, accepting;
+    std::vector<std::uint64_t> nibbleMasks;
+    void addClosure(std::size_t, std::vector<std::uint64_t>&) const;
+    bool runSmall(std::uint64_t&, const char*, std::size_t) const;
+    bool runLarge(std::vector<std::uint64_t>&, const char*, std::size_t) const;
+public:
+    NFASimulator(const TransitionTable&, std::shared_ptr<const EpsilonClosure>, const std::set<char>&, const std::set<std::size_t>&);
+    const std::vector<std::uint64_t>& initial() const noexcept;
+    bool run(std::vector<std::uint64_t>&, const char*, std::size_t) const;
+    bool accepts(const std::vector<std::uint64_t>&) const noexcept;
+    bool operator()(const char*, std::size_t) const;
+};
+
+#endif // NFASIMULATOR_H
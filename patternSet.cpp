@@ -0,0 +1,104 @@
+#include "patternSet.h"
+#include <limits>
+#include <set>
+#include <stdexcept>
+
+/// State 0 is the common start state, with epsilon transitions to the start states of the automata, which follow it in order.
+TransitionTable PatternSet::join(const std::vector<Automaton>& automata, std::vector<std::uint32_t>& pattern)
+{
+    std::size_t states=1, edges=0;
+    for(auto&& a: automata)
+    {
+        states+=a.states;
+        edges+=a.transitions.size()+1;
+    }
+    if(states>std::numeric_limits<std::uint32_t>::max() || automata.size()>=none) throw std::length_error("Too many states for a pattern set");
+    pattern.assign(states, none);
+    std::vector<Transition> trans;
+    trans.reserve(edges);
+    std::size_t base=1;
+    for(std::size_t i=0; i<automata.size(); ++i)
+    {
+        auto&& a=automata[i];
+        if(!a.states) continue;
+        trans.emplace_back(0, Automaton::epsilon, base);
+        for(std::size_t s=0; s<a.states; ++s)
+            for(auto e=a.transitions.begin(s); e<a.transitions.end(s); ++e)
+                trans.emplace_back(s+base, a.transitions.label(e), a.transitions.target(e)+base);
+        for(auto f: a.finalStates)
+            pattern[f+base]=i;
+        base+=a.states;
+    }
+    return TransitionTable(states, std::move(trans));
+}
+
+std::set<char> PatternSet::alphabet(const std::vector<Automaton>& automata)
+{
+    std::set<char> res;
+    for(auto&& a: automata)
+        res.insert(a.alpha.begin(), a.alpha.end());
+    return res;
+}
+
+PatternSet::PatternSet(const std::vector<Automaton>& automata, std::size_t budget):
+    patterns(automata.size()), words((patterns+63)/64), cache(join(automata, pattern), alphabet(automata), budget, words*sizeof(std::uint64_t)) {}
+
+std::size_t PatternSet::size() const noexcept
+{
+    return patterns;
+}
+
+std::size_t PatternSet::intern(const std::vector<std::uint32_t>& subset)
+{
+    auto p=cache.intern(subset);
+    if(!p.second) return p.first;
+    masks.resize(masks.size()+words);
+    auto mask=masks.end()-words;
+    for(auto s: subset)
+        if(pattern[s]!=none) mask[pattern[s]/64]|=std::uint64_t(1)<<pattern[s]%64;
+    return p.first;
+}
+
+void PatternSet::flush()
+{
+    cache.flush();
+    masks.clear();
+    start=unknown;
+}
+
+/// The indices of the automata that accept the word, in increasing order.
+std::vector<std::size_t> PatternSet::operator()(const std::string& word)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if(start==unknown) start=intern(cache.initial());
+    std::vector<std::size_t> res;
+    auto current=start;
+    for(auto c: word)
+    {
+        auto l=cache.letter(c);
+        if(l==1) continue;
+        if(!l) return res;
+        auto cached=cache.transition(current, l-2);
+        if(cached!=unknown) current=cached;
+        else
+        {
+            auto subset=cache.successor(current, l-2);
+            if(!cache.fits(subset))
+            {
+                flush();
+                current=intern(subset);
+            }
+            else
+            {
+                auto target=intern(subset);
+                cache.link(current, l-2, target);
+                current=target;
+            }
+        }
+        if(cache.isDead(current)) return res;
+    }
+    for(std::size_t w=0; w<words; ++w)
+        for(auto bits=masks[current*words+w]; bits; bits&=bits-1)
+            res.push_back(w*64+__builtin_ctzll(bits));
+    return res;
+}
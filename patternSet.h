@@ -0,0 +1,39 @@
+#ifndef PATTERNSET_H
+#define PATTERNSET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+#include "automaton.h"
+#include "transitionTable.h"
+#include "subsetCache.h"
+
+/// Matches a word against many automata in one pass.
+/// The automata are joined under a common start state and determinized on the fly, as in LazyDFA; every DFA state
+/// carries the bitmask of the automata that accept in it, so a single scan of the word tells which of them accept it.
+/// The cache of DFA states is flushed when it outgrows its memory budget. Matching is serialized by a lock.
+class PatternSet
+{
+    static constexpr std::size_t unknown=SubsetCache::unknown;
+    static constexpr std::uint32_t none=-1;
+    std::size_t patterns, words;
+    std::vector<std::uint32_t> pattern; /// the automaton a final state belongs to, none for the other states
+    SubsetCache cache;
+    std::vector<std::uint64_t> masks;
+    std::size_t start=unknown;
+    std::mutex mutex;
+    static TransitionTable join(const std::vector<Automaton>&, std::vector<std::uint32_t>&);
+    static std::set<char> alphabet(const std::vector<Automaton>&);
+    std::size_t intern(const std::vector<std::uint32_t>&);
+    void flush();
+public:
+    static constexpr std::size_t defaultBudget=std::size_t(32)<<20;
+    PatternSet(const std::vector<Automaton>&, std::size_t=defaultBudget);
+    std::size_t size() const noexcept;
+    std::vector<std::size_t> operator()(const std::string&);
+};
+
+#endif // PATTERNSET_H
@@ -0,0 +1,56 @@
+#include "regexCache.h"
+#include "regularExpression.h"
+
+RegexCache::RegexCache(std::size_t capacity): capacity(capacity ? capacity : 1) {}
+
+RegexCache& RegexCache::global()
+{
+    static RegexCache cache;
+    return cache;
+}
+
+/// The expression is compiled outside the lock, so a miss does not hold up lookups of other expressions.
+Automaton RegexCache::get(const std::string& regex)
+{
+    RegularExpression reg(regex);
+    const auto& key=reg.reversePolishNotation();
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        auto it=index.find(key);
+        if(it!=index.end())
+        {
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->second;
+        }
+    }
+    auto compiled=reg.DFA();
+    compiled.minimize();
+    std::lock_guard<std::mutex> guard(lock);
+    auto it=index.find(key);
+    if(it!=index.end())
+    {
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->second;
+    }
+    entries.emplace_front(key, compiled);
+    index.emplace(key, entries.begin());
+    if(entries.size()>capacity)
+    {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+    return compiled;
+}
+
+std::size_t RegexCache::size() const
+{
+    std::lock_guard<std::mutex> guard(lock);
+    return entries.size();
+}
+
+void RegexCache::clear()
+{
+    std::lock_guard<std::mutex> guard(lock);
+    index.clear();
+    entries.clear();
+}
@@ -0,0 +1,30 @@
+#ifndef REGEXCACHE_H
+#define REGEXCACHE_H
+
+#include <cstddef>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include "Automaton.h"
+
+/// Least-recently-used cache of minimal DFAs of regular expressions, keyed by their reverse Polish notation,
+/// so expressions differing only in redundant parentheses share an entry. Safe to use from several threads.
+class RegexCache
+{
+    using Entry=std::pair<std::string, Automaton>;
+    std::size_t capacity;
+    std::list<Entry> entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    mutable std::mutex lock;
+public:
+    static constexpr std::size_t defaultCapacity=512;
+    explicit RegexCache(std::size_t=defaultCapacity);
+    static RegexCache& global();
+    Automaton get(const std::string&);
+    std::size_t size() const;
+    void clear();
+};
+
+#endif // REGEXCACHE_H
@@ -1,142 +1,413 @@
-#include "regularExpression.h"
-#include <cstddef>
-#include <stdexcept>
-#include <stack>
-#include <utility>
-
-RegularExpression::RegularExpression(const std::string& r): regex(r), RPN(produceRPN()) {}
-
-bool RegularExpression::isLetter(char c)
-{
-    return c>='a' && c<='z' || c>='0' && c<='9';
-}
-
-bool RegularExpression::isOperator(char c)
-{
-    return c=='|' || c=='&' || c=='*';
-}
-
-int RegularExpression::precedence(char c)
-{
-    switch(c)
-    {
-    case '|': return 1;
-    case '&': return 2;
-    case '*': return 3;
-    default: throw std::logic_error("Bad regular expression");
-    }
-}
-
-std::string RegularExpression::produceRPN() const
-{
-    if(regex.empty()) return {};
-    std::string expr, res;
-    expr.push_back(regex[0]);
-    for(std::size_t i=1; i<regex.size(); ++i)
-    {
-        if((isLetter(regex[i]) || regex[i]==Automaton::epsilon || regex[i]=='(') && regex[i-1]!='(' && regex[i-1]!='|')
-            expr.push_back('&'); /// add concatenation operator
-        expr.push_back(regex[i]);
-    }
-    std::stack<char> op;
-    for(char c: expr)
-    {
-        if(isLetter(c) || c==Automaton::epsilon) res.push_back(c);
-        else if(isOperator(c))
-        {
-            /*if(c=='*')
-            {
-                res.push_back(c);
-                continue;
-            }*/
-            while(!op.empty() && op.top()!='(' && precedence(op.top())>=precedence(c))
-            {
-                res.push_back(op.top());
-                op.pop();
-            }
-            op.push(c);
-        }
-        else if(c=='(') op.push(c);
-        else if(c==')')
-        {
-            while(!op.empty() && op.top()!='(')
-            {
-                res.push_back(op.top());
-                op.pop();
-            }
-            if(op.empty()) throw std::logic_error("Bad regular expression: mismatched parentheses");
-            op.pop();
-        }
-
-    }
-    while(!op.empty())
-    {
-        if(op.top()=='(') throw std::logic_error("Bad regular expression: mismatched parentheses");
-        res.push_back(op.top());
-        op.pop();
-    }
-    return res;
-}
-
-const std::string& RegularExpression::expression() const
-{
-    return regex;
-}
-
-const std::string& RegularExpression::reversePolishNotation() const
-{
-    return RPN;
-}
-
-Automaton RegularExpression::NFA() const
-{
-    std::stack<Automaton> s;
-    for(char c: RPN)
-    {
-        switch(c)
-        {
-        case '*':
-            {
-                if(s.empty()) throw std::runtime_error("Bad regular expression");
-                auto result=s.top().KleeneStar();
-                s.pop();
-                s.push(std::move(result));
-                break;
-            }
-        case '&':
-            {
-                if(s.size()<2) throw std::runtime_error("Bad regular expression");
-                auto op2=std::move(s.top());
-                s.pop();
-                auto op1=std::move(s.top());
-                s.pop();
-                s.push(op1.Concatenation(op2));
-                break;
-            }
-        case '|':
-            {
-                if(s.size()<2) throw std::runtime_error("Bad regular expression");
-                auto op2=std::move(s.top());
-                s.pop();
-                auto op1=std::move(s.top());
-                s.pop();
-                s.push(op1.Union(op2));
-                break;
-            }
-        default:
-            if(isLetter(c) || c==Automaton::epsilon)
-            {
-                Automaton tmp;
-                tmp.states=2;
-                if(c!=Automaton::epsilon) tmp.alpha.insert(c);
-                tmp.transitions.emplace(0,c,1);
-                tmp.finalStates.insert(1);
-                tmp.deterministic=c!=Automaton::epsilon;
-                s.push(std::move(tmp));
-            }
-        }
-    }
-    if(s.size()!=1) throw std::runtime_error("Bad regular expression");
-    return s.top();
-}
-
+#include "regularExpression.h"
+#include "subsetTable.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <stack>
+#include <utility>
+
+RegularExpression::RegularExpression(const std::string& r): regex(r), RPN(produceRPN()) {}
+
+bool RegularExpression::isLetter(char c)
+{
+    return c>='a' && c<='z' || c>='0' && c<='9';
+}
+
+bool RegularExpression::isOperator(char c)
+{
+    return c=='|' || c=='&' || c=='*';
+}
+
+int RegularExpression::precedence(char c)
+{
+    switch(c)
+    {
+    case '|': return 1;
+    case '&': return 2;
+    case '*': return 3;
+    default: throw std::logic_error("Bad regular expression");
+    }
+}
+
+std::string RegularExpression::produceRPN() const
+{
+    if(regex.empty()) return {};
+    std::string expr, res;
+    expr.push_back(regex[0]);
+    for(std::size_t i=1; i<regex.size(); ++i)
+    {
+        if((isLetter(regex[i]) || regex[i]==Automaton::epsilon || regex[i]=='(') && regex[i-1]!='(' && regex[i-1]!='|')
+            expr.push_back('&'); /// add concatenation operator
+        expr.push_back(regex[i]);
+    }
+    std::stack<char> op;
+    for(char c: expr)
+    {
+        if(isLetter(c) || c==Automaton::epsilon) res.push_back(c);
+        else if(isOperator(c))
+        {
+            /*if(c=='*')
+            {
+                res.push_back(c);
+                continue;
+            }*/
+            while(!op.empty() && op.top()!='(' && precedence(op.top())>=precedence(c))
+            {
+                res.push_back(op.top());
+                op.pop();
+            }
+            op.push(c);
+        }
+        else if(c=='(') op.push(c);
+        else if(c==')')
+        {
+            while(!op.empty() && op.top()!='(')
+            {
+                res.push_back(op.top());
+                op.pop();
+            }
+            if(op.empty()) throw std::logic_error("Bad regular expression: mismatched parentheses");
+            op.pop();
+        }
+
+    }
+    while(!op.empty())
+    {
+        if(op.top()=='(') throw std::logic_error("Bad regular expression: mismatched parentheses");
+        res.push_back(op.top());
+        op.pop();
+    }
+    return res;
+}
+
+const std::string& RegularExpression::expression() const
+{
+    return regex;
+}
+
+const std::string& RegularExpression::reversePolishNotation() const
+{
+    return RPN;
+}
+
+/// Node of the syntax tree; the nodes are stored in the order of the RPN, so children always precede their parent.
+/// For the Thompson construction, [base, base+size) is the block of states of the subexpression;
+/// for the Glushkov construction, base is the position of a letter.
+struct RegularExpression::Node
+{
+    char symbol;
+    std::size_t left, right;
+    std::size_t size, base;
+    bool nullable;
+};
+
+std::pmr::vector<RegularExpression::Node> RegularExpression::syntaxTree(std::pmr::memory_resource* arena) const
+{
+    std::pmr::vector<Node> tree(arena);
+    tree.reserve(RPN.size());
+    std::pmr::vector<std::size_t> s(arena);
+    for(char c: RPN)
+    {
+        Node n{c, 0, 0, 2, 0, c==Automaton::epsilon};
+        if(isOperator(c))
+        {
+            if(s.size()<(c=='*' ? 1 : 2)) throw std::runtime_error("Bad regular expression");
+            if(c!='*')
+            {
+                n.right=s.back();
+                s.pop_back();
+            }
+            n.left=s.back();
+            s.pop_back();
+            const Node &l=tree[n.left], &r=tree[n.right];
+            switch(c)
+            {
+            case '*':
+                n.size=l.size+1;
+                n.nullable=true;
+                break;
+            case '&':
+                n.size=l.size+r.size;
+                n.nullable=l.nullable && r.nullable;
+                break;
+            case '|':
+                n.size=l.size+r.size+1;
+                n.nullable=l.nullable || r.nullable;
+                break;
+            }
+        }
+        else if(!isLetter(c) && c!=Automaton::epsilon) continue;
+        s.push_back(tree.size());
+        tree.push_back(n);
+    }
+    if(s.size()!=1) throw std::runtime_error("Bad regular expression");
+    return tree;
+}
+
+/// Appends to res the final states of the Thompson automaton of the subexpression rooted at node.
+void RegularExpression::finalStates(const std::pmr::vector<Node>& tree, std::size_t node, std::pmr::vector<std::size_t>& res,
+                                    std::pmr::vector<std::size_t>& pending)
+{
+    pending.assign(1, node);
+    while(!pending.empty())
+    {
+        const Node& n=tree[pending.back()];
+        pending.pop_back();
+        switch(n.symbol)
+        {
+        case '*':
+            res.push_back(n.base);
+            pending.push_back(n.left);
+            break;
+        case '&':
+            pending.push_back(n.right);
+            break;
+        case '|':
+            pending.push_back(n.right);
+            pending.push_back(n.left);
+            break;
+        default:
+            res.push_back(n.base+1);
+        }
+    }
+}
+
+/// Appends to res the positions that can end (last=true) or begin (last=false) a word of the subexpression rooted at node.
+void RegularExpression::positions(const std::pmr::vector<Node>& tree, std::size_t node, std::pmr::vector<std::size_t>& res,
+                                  std::pmr::vector<std::size_t>& pending, bool last)
+{
+    pending.assign(1, node);
+    while(!pending.empty())
+    {
+        const Node& n=tree[pending.back()];
+        pending.pop_back();
+        switch(n.symbol)
+        {
+        case '*':
+            pending.push_back(n.left);
+            break;
+        case '&':
+            pending.push_back(last ? n.right : n.left);
+            if(tree[pending.back()].nullable) pending.push_back(last ? n.left : n.right);
+            break;
+        case '|':
+            pending.push_back(n.right);
+            pending.push_back(n.left);
+            break;
+        default:
+            if(n.symbol!=Automaton::epsilon) res.push_back(n.base);
+        }
+    }
+}
+
+/// The same automaton as combining the subexpressions with Union, Concatenation and KleeneStar,
+/// but the state blocks are laid out top-down on the syntax tree and all transitions go into one buffer.
+Automaton RegularExpression::thompson(std::pmr::memory_resource* arena) const
+{
+    auto tree=syntaxTree(arena);
+    tree.back().base=0;
+    for(auto i=tree.size(); i--;)
+    {
+        const Node& n=tree[i];
+        switch(n.symbol)
+        {
+        case '*':
+            tree[n.left].base=n.base+1;
+            break;
+        case '&':
+            tree[n.left].base=n.base;
+            tree[n.right].base=n.base+tree[n.left].size;
+            break;
+        case '|':
+            tree[n.left].base=n.base+1;
+            tree[n.right].base=n.base+1+tree[n.left].size;
+            break;
+        }
+    }
+    Automaton res;
+    std::pmr::vector<Transition> trans(arena);
+    trans.reserve(2*tree.size());
+    std::pmr::vector<std::size_t> finals(arena), pending(arena);
+    for(auto& n: tree)
+    {
+        finals.clear();
+        switch(n.symbol)
+        {
+        case '*':
+            trans.emplace_back(n.base, Automaton::epsilon, n.base+1);
+            finalStates(tree, n.left, finals, pending);
+            for(auto f: finals)
+                trans.emplace_back(f, Automaton::epsilon, n.base);
+            break;
+        case '&':
+            finalStates(tree, n.left, finals, pending);
+            for(auto f: finals)
+                trans.emplace_back(f, Automaton::epsilon, tree[n.right].base);
+            break;
+        case '|':
+            trans.emplace_back(n.base, Automaton::epsilon, n.base+1);
+            trans.emplace_back(n.base, Automaton::epsilon, tree[n.right].base);
+            break;
+        default:
+            trans.emplace_back(n.base, n.symbol, n.base+1);
+            if(n.symbol!=Automaton::epsilon) res.alpha.insert(n.symbol);
+        }
+    }
+    finals.clear();
+    finalStates(tree, tree.size()-1, finals, pending);
+    std::sort(finals.begin(), finals.end());
+    res.finalStates.insert(finals.begin(), finals.end());
+    res.states=tree.back().size;
+    res.transitions=TransitionTable(res.states, trans.data(), trans.data()+trans.size());
+    res.deterministic=tree.size()==1 && tree[0].symbol!=Automaton::epsilon;
+    return res;
+}
+
+/// Position automaton: state 0 is initial and state i is entered by reading the i-th letter of the expression,
+/// so there are no epsilon transitions and the transitions into a state all carry the same letter.
+Automaton RegularExpression::glushkov(std::pmr::memory_resource* arena) const
+{
+    auto tree=syntaxTree(arena);
+    std::size_t count=0;
+    std::pmr::vector<char> letter(1, arena);
+    for(auto& n: tree)
+    {
+        if(!isOperator(n.symbol) && n.symbol!=Automaton::epsilon)
+        {
+            n.base=++count;
+            letter.push_back(n.symbol);
+        }
+    }
+    Automaton res;
+    std::pmr::vector<Transition> trans(arena);
+    std::pmr::vector<std::size_t> from(arena), to(arena), pending(arena);
+    auto connect=[&](std::size_t l, std::size_t r)
+    {
+        from.clear();
+        to.clear();
+        positions(tree, l, from, pending, true);
+        positions(tree, r, to, pending, false);
+        for(auto p: from)
+            for(auto q: to)
+                trans.emplace_back(p, letter[q], q);
+    };
+    for(auto& n: tree)
+        if(n.symbol=='&') connect(n.left, n.right);
+        else if(n.symbol=='*') connect(n.left, n.left);
+        else if(!isOperator(n.symbol) && n.symbol!=Automaton::epsilon) res.alpha.insert(n.symbol);
+    to.clear();
+    positions(tree, tree.size()-1, to, pending, false);
+    for(auto q: to)
+        trans.emplace_back(0, letter[q], q);
+    from.clear();
+    positions(tree, tree.size()-1, from, pending, true);
+    if(tree.back().nullable) from.push_back(0);
+    std::sort(from.begin(), from.end());
+    res.finalStates.insert(from.begin(), from.end());
+    res.states=count+1;
+    res.transitions=TransitionTable(res.states, trans.data(), trans.data()+trans.size());
+    res.deterministic=res.isDeterm();
+    return res;
+}
+
+/// The temporaries of the construction come from an arena that is released as a whole at the end.
+Automaton RegularExpression::NFA(Construction construction) const
+{
+    std::pmr::monotonic_buffer_resource arena;
+    return construction==Construction::glushkov ? glushkov(&arena) : thompson(&arena);
+}
+
+/// Followpos construction: the states of the DFA are the sets of positions that can be reached after reading a word,
+/// built directly from the syntax tree. Position 0 stands for the beginning of the word and is followed by the first positions.
+/// The result is the complete DFA the subset construction gives for the Glushkov automaton.
+Automaton RegularExpression::DFA() const
+{
+    std::pmr::monotonic_buffer_resource arena;
+    auto tree=syntaxTree(&arena);
+    std::pmr::vector<char> letter(1, &arena);
+    for(auto& n: tree)
+        if(!isOperator(n.symbol) && n.symbol!=Automaton::epsilon)
+        {
+            n.base=letter.size();
+            letter.push_back(n.symbol);
+        }
+    if(letter.size()>std::numeric_limits<std::uint32_t>::max()) throw std::length_error("Regular expression is too long");
+    std::pmr::vector<std::pair<std::size_t, std::size_t>> follow(&arena);
+    std::pmr::vector<std::size_t> from(&arena), to(&arena), pending(&arena);
+    auto connect=[&](std::size_t l, std::size_t r)
+    {
+        from.clear();
+        to.clear();
+        positions(tree, l, from, pending, true);
+        positions(tree, r, to, pending, false);
+        for(auto p: from)
+            for(auto q: to)
+                follow.emplace_back(p, q);
+    };
+    for(auto& n: tree)
+        if(n.symbol=='&') connect(n.left, n.right);
+        else if(n.symbol=='*') connect(n.left, n.left);
+    to.clear();
+    positions(tree, tree.size()-1, to, pending, false);
+    for(auto q: to)
+        follow.emplace_back(0, q);
+    std::pmr::vector<char> letters(letter.begin()+1, letter.end(), &arena);
+    std::sort(letters.begin(), letters.end());
+    letters.erase(std::unique(letters.begin(), letters.end()), letters.end());
+    std::size_t k=letters.size();
+    /// follow is grouped by position, then by letter, so a letter's successors of a position form one range
+    std::sort(follow.begin(), follow.end(), [&](const std::pair<std::size_t, std::size_t>& a, const std::pair<std::size_t, std::size_t>& b)
+    {
+        if(a.first!=b.first) return a.first<b.first;
+        if(letter[a.second]!=letter[b.second]) return letter[a.second]<letter[b.second];
+        return a.second<b.second;
+    });
+    follow.erase(std::unique(follow.begin(), follow.end()), follow.end());
+    std::pmr::vector<std::size_t> offsets(letter.size()*k+1, &arena);
+    for(auto&& f: follow)
+        ++offsets[f.first*k+(std::lower_bound(letters.begin(), letters.end(), letter[f.second])-letters.begin())+1];
+    for(std::size_t i=1; i<offsets.size(); ++i)
+        offsets[i]+=offsets[i-1];
+    std::pmr::vector<bool> last(letter.size(), false, &arena);
+    from.clear();
+    positions(tree, tree.size()-1, from, pending, true);
+    for(auto p: from)
+        last[p]=true;
+    last[0]=tree.back().nullable;
+    Automaton res;
+    res.alpha.insert(letters.begin(), letters.end());
+    SubsetTable subsets;
+    std::uint32_t start=0;
+    subsets.intern(&start, &start+1);
+    std::pmr::vector<std::uint32_t> succ(&arena);
+    std::pmr::vector<std::size_t> mark(letter.size(), &arena);
+    std::pmr::vector<Transition> trans(&arena);
+    for(std::size_t id=0, stamp=0; id<subsets.size(); ++id)
+    {
+        for(auto p=subsets.begin(id); p!=subsets.end(id); ++p)
+            if(last[*p])
+            {
+                res.finalStates.insert(res.finalStates.end(), id);
+                break;
+            }
+        for(std::size_t a=0; a<k; ++a)
+        {
+            succ.clear();
+            ++stamp;
+            for(auto p=subsets.begin(id); p!=subsets.end(id); ++p)
+                for(auto f=offsets[*p*k+a]; f<offsets[*p*k+a+1]; ++f)
+                    if(mark[follow[f].second]!=stamp)
+                    {
+                        mark[follow[f].second]=stamp;
+                        succ.push_back(follow[f].second);
+                    }
+            std::sort(succ.begin(), succ.end());
+            trans.emplace_back(id, letters[a], subsets.intern(succ.data(), succ.data()+succ.size()).first);
+        }
+    }
+    res.states=subsets.size();
+    res.transitions=TransitionTable(res.states, trans.data(), trans.data()+trans.size());
+    return res;
+}
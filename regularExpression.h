@@ -1,22 +1,33 @@
-#ifndef REGULAREXPRESSION_H
-#define REGULAREXPRESSION_H
-
-#include <string>
-#include "Automaton.h"
-
-class RegularExpression
-{
-    std::string regex, RPN;
-    std::string produceRPN() const;
-    static bool isLetter(char);
-    static bool isOperator(char);
-    static int precedence(char);
-public:
-    RegularExpression() = default;
-    RegularExpression(const std::string&);
-    const std::string& expression() const;
-    const std::string& reversePolishNotation() const;
-    Automaton NFA() const;
-};
-
-#endif // REGULAREXPRESSION_H
+#ifndef REGULAREXPRESSION_H
+#define REGULAREXPRESSION_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <string>
+#include <vector>
+#include "Automaton.h"
+
+class RegularExpression
+{
+    struct Node;
+    std::string regex, RPN;
+    std::string produceRPN() const;
+    std::pmr::vector<Node> syntaxTree(std::pmr::memory_resource*) const;
+    static void finalStates(const std::pmr::vector<Node>&, std::size_t, std::pmr::vector<std::size_t>&, std::pmr::vector<std::size_t>&);
+    static void positions(const std::pmr::vector<Node>&, std::size_t, std::pmr::vector<std::size_t>&, std::pmr::vector<std::size_t>&, bool);
+    Automaton thompson(std::pmr::memory_resource*) const;
+    Automaton glushkov(std::pmr::memory_resource*) const;
+    static bool isLetter(char);
+    static bool isOperator(char);
+    static int precedence(char);
+public:
+    enum class Construction {thompson, glushkov};
+    RegularExpression() = default;
+    RegularExpression(const std::string&);
+    const std::string& expression() const;
+    const std::string& reversePolishNotation() const;
+    Automaton NFA(Construction=Construction::thompson) const;
+    Automaton DFA() const;
+};
+
+#endif // REGULAREXPRESSION_H
@@ -0,0 +1,40 @@
+#include "streamMatcher.h"
+#include <utility>
+
+StreamMatcher::StreamMatcher(std::shared_ptr<const CompiledDFA> dfa, std::unique_ptr<LazyDFA> lazy, std::shared_ptr<const NFASimulator> simulator):
+    dfa(std::move(dfa)), lazy(std::move(lazy)), simulator(std::move(simulator))
+{
+    reset();
+}
+
+void StreamMatcher::reset()
+{
+    alive=true;
+    if(dfa) state=dfa->initial();
+    else if(lazy) lazy->reset();
+    else active=simulator->initial();
+}
+
+void StreamMatcher::feed(const char* chunk, std::size_t length)
+{
+    if(!alive) return;
+    if(dfa)
+    {
+        state=dfa->run(state, chunk, length);
+        alive=!dfa->isDead(state);
+    }
+    else if(lazy) alive=lazy->feed(chunk, length);
+    else alive=simulator->run(active, chunk, length);
+}
+
+/// Returns whether everything fed since the last call forms an accepted word, and starts over.
+bool StreamMatcher::finish()
+{
+    bool res;
+    if(!alive) res=false;
+    else if(dfa) res=dfa->accepts(state);
+    else if(lazy) res=lazy->accepts();
+    else res=simulator->accepts(active);
+    reset();
+    return res;
+}
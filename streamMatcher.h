@@ -0,0 +1,30 @@
+#ifndef STREAMMATCHER_H
+#define STREAMMATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "compiledDFA.h"
+#include "lazyDFA.h"
+#include "nfaSimulator.h"
+
+/// Incremental membership test: the word is fed in chunks of any size and only the current state is kept between them
+/// (a state of the compiled DFA, or of a lazy DFA owned by the matcher, or the set of active states of the simulation).
+class StreamMatcher
+{
+    std::shared_ptr<const CompiledDFA> dfa;
+    std::unique_ptr<LazyDFA> lazy;
+    std::shared_ptr<const NFASimulator> simulator;
+    std::uint32_t state=0;
+    std::vector<std::uint64_t> active;
+    bool alive=true;
+    StreamMatcher(std::shared_ptr<const CompiledDFA>, std::unique_ptr<LazyDFA>, std::shared_ptr<const NFASimulator>);
+    void reset();
+    friend class Automaton;
+public:
+    void feed(const char*, std::size_t);
+    bool finish();
+};
+
+#endif // STREAMMATCHER_H
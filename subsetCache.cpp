@@ -0,0 +1,90 @@
+#include "subsetCache.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+SubsetCache::SubsetCache(const TransitionTable& transitions, std::shared_ptr<const EpsilonClosure> closures, const std::set<char>& alpha,
+                         std::size_t budget, std::size_t extra):
+    transitions(transitions), closures(std::move(closures)), letters(alpha.begin(), alpha.end()), letterOf(letters),
+    budget(budget), extra(extra), mark(transitions.states())
+{
+    if(transitions.states()>std::numeric_limits<std::uint32_t>::max()) throw std::length_error("Automaton is too large to be determinized on the fly");
+}
+
+SubsetCache::SubsetCache(const TransitionTable& transitions, const std::set<char>& alpha, std::size_t budget, std::size_t extra):
+    SubsetCache(transitions, std::make_shared<const EpsilonClosure>(transitions), alpha, budget, extra) {}
+
+std::size_t SubsetCache::size() const noexcept
+{
+    return subsets.size();
+}
+
+const std::uint32_t* SubsetCache::begin(std::size_t id) const noexcept
+{
+    return subsets.begin(id);
+}
+
+const std::uint32_t* SubsetCache::end(std::size_t id) const noexcept
+{
+    return subsets.end(id);
+}
+
+bool SubsetCache::isDead(std::size_t id) const noexcept
+{
+    return subsets.begin(id)==subsets.end(id);
+}
+
+/// The closure of the initial state, empty if there are no states.
+std::vector<std::uint32_t> SubsetCache::initial() const
+{
+    std::vector<std::uint32_t> res;
+    if(transitions.states()) res.assign(closures->begin(0), closures->end(0));
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+std::vector<std::uint32_t> SubsetCache::successor(std::size_t id, std::size_t letter)
+{
+    std::vector<std::uint32_t> res;
+    ++stamp;
+    for(auto it=subsets.begin(id); it!=subsets.end(id); ++it)
+        for(auto e=transitions.lowerBound(*it, letters[letter]); e<transitions.upperBound(*it, letters[letter]); ++e)
+        {
+            auto t=transitions.target(e);
+            if(mark[t]==stamp) continue;
+            for(auto it=closures->begin(t); it!=closures->end(t); ++it)
+                if(mark[*it]!=stamp)
+                {
+                    mark[*it]=stamp;
+                    res.push_back(*it);
+                }
+        }
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+/// Whether the subset can be added without the cache outgrowing its budget.
+bool SubsetCache::fits(const std::vector<std::uint32_t>& subset) const noexcept
+{
+    std::size_t used=subsets.memoryUsage()+next.size()*sizeof(std::size_t)+subsets.size()*extra;
+    return used+(2*subset.size()+letters.size()+5)*sizeof(std::size_t)+extra<=budget;
+}
+
+/// The id of the subset and whether it is new; a new one has no known transitions.
+std::pair<std::size_t, bool> SubsetCache::intern(const std::vector<std::uint32_t>& subset)
+{
+    auto p=subsets.intern(subset.data(), subset.data()+subset.size());
+    if(p.second) next.resize(next.size()+letters.size(), unknown);
+    return p;
+}
+
+void SubsetCache::link(std::size_t id, std::size_t letter, std::size_t target) noexcept
+{
+    next[id*letters.size()+letter]=target;
+}
+
+void SubsetCache::flush()
+{
+    subsets.clear();
+    next.clear();
+}
@@ -0,0 +1,55 @@
+#ifndef SUBSETCACHE_H
+#define SUBSETCACHE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <utility>
+#include <vector>
+#include "transitionTable.h"
+#include "epsilonClosure.h"
+#include "letterIndex.h"
+#include "subsetTable.h"
+
+/// The cache of an on-the-fly subset construction, shared by LazyDFA and PatternSet: the epsilon-closed sets of states
+/// met so far are interned as DFA states, and their transitions are remembered once computed. Letters are numbered
+/// from 0 in increasing order; letter() gives that number plus 2 for a character, as LetterIndex does.
+/// The owner keeps its own data for every DFA state (extra bytes of it are counted against the memory budget)
+/// and drops it when the cache is flushed.
+class SubsetCache
+{
+    TransitionTable transitions;
+    std::shared_ptr<const EpsilonClosure> closures;
+    std::vector<char> letters;
+    LetterIndex letterOf;
+    std::size_t budget, extra;
+    SubsetTable subsets;
+    std::vector<std::size_t> next;
+    std::vector<std::size_t> mark;
+    std::size_t stamp=0;
+public:
+    static constexpr std::size_t unknown=-1;
+    SubsetCache(const TransitionTable&, std::shared_ptr<const EpsilonClosure>, const std::set<char>&, std::size_t, std::size_t=0);
+    SubsetCache(const TransitionTable&, const std::set<char>&, std::size_t, std::size_t=0);
+    std::size_t letter(char c) const noexcept
+    {
+        return letterOf(c);
+    }
+    std::size_t transition(std::size_t id, std::size_t letter) const noexcept
+    {
+        return next[id*letters.size()+letter];
+    }
+    std::size_t size() const noexcept;
+    const std::uint32_t* begin(std::size_t) const noexcept;
+    const std::uint32_t* end(std::size_t) const noexcept;
+    bool isDead(std::size_t) const noexcept;
+    std::vector<std::uint32_t> initial() const;
+    std::vector<std::uint32_t> successor(std::size_t, std::size_t);
+    bool fits(const std::vector<std::uint32_t>&) const noexcept;
+    std::pair<std::size_t, bool> intern(const std::vector<std::uint32_t>&);
+    void link(std::size_t, std::size_t, std::size_t) noexcept;
+    void flush();
+};
+
+#endif // SUBSETCACHE_H
@@ -0,0 +1,76 @@
+#include "subsetTable.h"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+std::uint64_t SubsetTable::hash(const std::uint32_t* first, const std::uint32_t* last) noexcept
+{
+    std::uint64_t h=0xcbf29ce484222325ull^static_cast<std::uint64_t>(last-first);
+    for(; first!=last; ++first)
+        h=(h^*first)*0x100000001b3ull;
+    h^=h>>33;
+    h*=0xff51afd7ed558ccdull;
+    return h^h>>33;
+}
+
+void SubsetTable::grow()
+{
+    slots.assign(slots.empty() ? 16 : 2*slots.size(), 0);
+    std::size_t mask=slots.size()-1;
+    for(std::size_t id=0; id<hashes.size(); ++id)
+    {
+        std::size_t i=hashes[id]&mask;
+        while(slots[i]) i=(i+1)&mask;
+        slots[i]=id+1;
+    }
+}
+
+std::pair<std::size_t, bool> SubsetTable::intern(const std::uint32_t* first, const std::uint32_t* last)
+{
+    return intern(first, last, hash(first, last));
+}
+
+std::pair<std::size_t, bool> SubsetTable::intern(const std::uint32_t* first, const std::uint32_t* last, std::uint64_t h)
+{
+    if(2*(hashes.size()+1)>slots.size()) grow();
+    std::size_t mask=slots.size()-1, i=h&mask;
+    for(; slots[i]; i=(i+1)&mask)
+    {
+        std::size_t id=slots[i]-1;
+        if(hashes[id]==h && std::equal(first, last, begin(id), end(id))) return {id, false};
+    }
+    if(hashes.size()>=std::numeric_limits<std::uint32_t>::max()) throw std::length_error("Too many subsets");
+    slots[i]=hashes.size()+1;
+    hashes.push_back(h);
+    members.insert(members.end(), first, last);
+    offsets.push_back(members.size());
+    return {hashes.size()-1, true};
+}
+
+std::size_t SubsetTable::size() const noexcept
+{
+    return hashes.size();
+}
+
+const std::uint32_t* SubsetTable::begin(std::size_t id) const noexcept
+{
+    return members.data()+offsets[id];
+}
+
+const std::uint32_t* SubsetTable::end(std::size_t id) const noexcept
+{
+    return members.data()+offsets[id+1];
+}
+
+std::size_t SubsetTable::memoryUsage() const noexcept
+{
+    return members.size()*sizeof(std::uint32_t)+offsets.size()*sizeof(std::size_t)+hashes.size()*sizeof(std::uint64_t)+slots.size()*sizeof(std::uint32_t);
+}
+
+void SubsetTable::clear() noexcept
+{
+    members.clear();
+    offsets.assign(1, 0);
+    hashes.clear();
+    slots.clear();
+}
@@ -0,0 +1,29 @@
+#ifndef SUBSETTABLE_H
+#define SUBSETTABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/// Interns sorted sets of states: every distinct set is stored once, contiguously, and gets the next free id.
+/// Lookup goes through an open-addressing hash table keyed by a precomputed hash of the set.
+class SubsetTable
+{
+    std::vector<std::uint32_t> members;
+    std::vector<std::size_t> offsets{0};
+    std::vector<std::uint64_t> hashes;
+    std::vector<std::uint32_t> slots;
+    void grow();
+public:
+    static std::uint64_t hash(const std::uint32_t*, const std::uint32_t*) noexcept;
+    std::pair<std::size_t, bool> intern(const std::uint32_t*, const std::uint32_t*);
+    std::pair<std::size_t, bool> intern(const std::uint32_t*, const std::uint32_t*, std::uint64_t);
+    std::size_t size() const noexcept;
+    const std::uint32_t* begin(std::size_t) const noexcept;
+    const std::uint32_t* end(std::size_t) const noexcept;
+    std::size_t memoryUsage() const noexcept;
+    void clear() noexcept;
+};
+
+#endif // SUBSETTABLE_H
@@ -0,0 +1,53 @@
+/// Checks that a union of DFAs, which is determinized as the product of its operands, ends up with the same complete
+/// deterministic automaton flags and the same minimal automaton as the subset construction of the whole expression.
+/// Build from the repository root: g++ -std=c++17 -I. tests/unionRoutes.cpp $(ls *.cpp | grep -v main.cpp) -pthread
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include "automaton.h"
+#include "regularExpression.h"
+
+namespace
+{
+    std::string print(const Automaton& a)
+    {
+        std::ostringstream os;
+        os << a;
+        return os.str();
+    }
+
+    bool deterministicAfterReload(const Automaton& a)
+    {
+        std::istringstream is(print(a));
+        return Automaton(is).isDeterministic();
+    }
+}
+
+int main()
+{
+    const std::pair<const char*, const char*> cases[]={
+        {"a", "b"}, {"a", "a"}, {"ab", "b"}, {"(a|b)*a", "b"}, {"a*", "b*"}, {"abc", "(a|c)*"}, {"E", "a"}, {"(ab)*", "a(ba)*"}
+    };
+    int failures=0;
+    for(auto&& c: cases)
+    {
+        Automaton direct=RegularExpression("(" + std::string(c.first) + ")|(" + c.second + ")").NFA();
+        direct.minimize();
+        Automaton parts=RegularExpression(c.first).DFA().Union(RegularExpression(c.second).DFA());
+        parts.convertToDFA();
+        if(!parts.isDeterministic() || !deterministicAfterReload(parts))
+        {
+            std::cout << "not a complete DFA: " << c.first << " | " << c.second << '\n';
+            ++failures;
+        }
+        parts.minimize();
+        if(print(parts)!=print(direct))
+        {
+            std::cout << "different minimal automata: " << c.first << " | " << c.second << '\n';
+            ++failures;
+        }
+    }
+    std::cout << failures << " failures\n";
+    return failures!=0;
+}
@@ -0,0 +1,29 @@
+#include "textSearcher.h"
+#include <algorithm>
+
+/// forward: \Sigma^*L, anchored: L, backward: \Sigma^* followed by the reversal of L;
+/// starters: the letters that can begin a nonempty match, or none if there are too many of them or the empty word matches.
+TextSearcher::TextSearcher(CompiledDFA forward, CompiledDFA anchored, CompiledDFA backward, std::string starters):
+    forward(std::move(forward)), anchored(std::move(anchored)), backward(std::move(backward)), starters(std::move(starters)) {}
+
+std::vector<TextSearcher::Match> TextSearcher::operator()(const char* text, std::size_t length, Mode mode) const
+{
+    std::vector<Match> res;
+    if(anchored.isDead(anchored.initial())) return res;
+    if(mode==Mode::all) return anchored.longestMatches(text, length, starters);
+    auto state=forward.initial();
+    std::size_t end=forward.accepts(state) ? 0 : forward.findAccepting(state, text, length, starters);
+    if(!forward.accepts(state)) return res;
+    /// some match exists; one backward pass marks every position where a match starts
+    std::vector<bool> starts;
+    backward.markAcceptingSuffixes(text, length, starts);
+    for(std::size_t from=0; from<=length;)
+    {
+        std::size_t begin=std::find(starts.begin()+from, starts.end(), true)-starts.begin();
+        if(begin>length) break;
+        end=begin+anchored.longestPrefix(text+begin, length-begin);
+        res.emplace_back(begin, end);
+        from=end>begin ? end : begin+1;
+    }
+    return res;
+}
@@ -0,0 +1,30 @@
+#ifndef TEXTSEARCHER_H
+#define TEXTSEARCHER_H
+
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+#include "compiledDFA.h"
+
+/// Finds the occurrences of the language L of an automaton in a text, as [start, end) ranges of byte offsets.
+/// Match ends are found by a forward scan with the DFA of \Sigma^*L, which skips ahead with memchr (or SIMD compares)
+/// while no match is in progress, if at most three letters can begin a match. Both modes take time linear in the text
+/// (times the number of states for Mode::all).
+/// As in recognition, the epsilon symbol is skipped; bytes outside the alphabet never belong to a match.
+class TextSearcher
+{
+    CompiledDFA forward, anchored, backward;
+    std::string starters;
+    TextSearcher(CompiledDFA, CompiledDFA, CompiledDFA, std::string);
+    friend class Automaton;
+public:
+    /// leftmostLongest: non-overlapping matches, each the longest one at the leftmost position where a match starts
+    /// all: for every position where a match ends, the longest match that ends there, i.e. the one with the leftmost start;
+    ///      the starts are found in the same forward pass by the DFA of L run from every position
+    enum class Mode {leftmostLongest, all};
+    using Match=std::pair<std::size_t, std::size_t>;
+    std::vector<Match> operator()(const char*, std::size_t, Mode=Mode::leftmostLongest) const;
+};
+
+#endif // TEXTSEARCHER_H
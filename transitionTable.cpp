@@ -0,0 +1,126 @@
+#include "transitionTable.h"
+#include <algorithm>
+#include <utility>
+
+namespace
+{
+    constexpr std::size_t noOffsets[1]={};
+}
+
+TransitionTable::TransitionTable() noexcept: offsets(noOffsets) {}
+
+TransitionTable::TransitionTable(std::size_t states, std::vector<Transition> edges):
+    TransitionTable(states, edges.data(), edges.data()+edges.size()) {}
+
+/// Sorts the transitions in place, so they may live in any buffer (e.g. one from a construction arena); the table copies them.
+TransitionTable::TransitionTable(std::size_t states, Transition* first, Transition* last)
+{
+    std::sort(first, last);
+    last=std::unique(first, last, [](const Transition& a, const Transition& b) {return !(a<b) && !(b<a);});
+    Arrays data;
+    data.offsets.resize(states+1);
+    data.labels.reserve(last-first);
+    data.targets.reserve(last-first);
+    for(auto t=first; t!=last; ++t)
+    {
+        ++data.offsets[t->From()+1];
+        data.labels.push_back(t->Label());
+        data.targets.push_back(t->To());
+    }
+    for(std::size_t i=0; i<states; ++i)
+        data.offsets[i+1]+=data.offsets[i];
+    *this=TransitionTable(std::move(data));
+}
+
+/// Takes arrays that are already laid out as described in the header; offsets holds one entry more than there are states.
+TransitionTable::TransitionTable(Arrays data)
+{
+    auto owned=std::make_shared<Arrays>(std::move(data));
+    arrays=owned.get();
+    offsets=owned->offsets.data();
+    labels=owned->labels.data();
+    targets=owned->targets.data();
+    stateCount=owned->offsets.size()-1;
+    edgeCount=owned->labels.size();
+    storage=std::move(owned);
+}
+
+/// Views arrays already laid out as described above; the owner keeps them alive and the caller is responsible for their validity.
+TransitionTable::TransitionTable(std::size_t states, std::size_t edges, const std::size_t* offsets, const char* labels,
+                                 const std::size_t* targets, std::shared_ptr<const void> owner) noexcept:
+    storage(std::move(owner)), offsets(offsets), labels(labels), targets(targets), stateCount(states), edgeCount(edges) {}
+
+std::size_t TransitionTable::states() const noexcept
+{
+    return stateCount;
+}
+
+std::size_t TransitionTable::size() const noexcept
+{
+    return edgeCount;
+}
+
+bool TransitionTable::empty() const noexcept
+{
+    return !edgeCount;
+}
+
+std::size_t TransitionTable::begin(std::size_t state) const noexcept
+{
+    return offsets[state];
+}
+
+std::size_t TransitionTable::end(std::size_t state) const noexcept
+{
+    return offsets[state+1];
+}
+
+std::size_t TransitionTable::lowerBound(std::size_t state, char label) const noexcept
+{
+    return std::lower_bound(labels+offsets[state], labels+offsets[state+1], label)-labels;
+}
+
+std::size_t TransitionTable::upperBound(std::size_t state, char label) const noexcept
+{
+    return std::upper_bound(labels+offsets[state], labels+offsets[state+1], label)-labels;
+}
+
+char TransitionTable::label(std::size_t edge) const noexcept
+{
+    return labels[edge];
+}
+
+std::size_t TransitionTable::target(std::size_t edge) const noexcept
+{
+    return targets[edge];
+}
+
+/// Leaves the table empty and returns its arrays: moved out if no copy of the table shares them, copied otherwise.
+TransitionTable::Arrays TransitionTable::release() &&
+{
+    Arrays res;
+    if(arrays && storage.use_count()==1) res=std::move(*arrays);
+    else
+    {
+        res.offsets.assign(offsets, offsets+stateCount+1);
+        res.labels.assign(labels, labels+edgeCount);
+        res.targets.assign(targets, targets+edgeCount);
+    }
+    *this=TransitionTable();
+    return res;
+}
+
+const std::size_t* TransitionTable::offsetData() const noexcept
+{
+    return offsets;
+}
+
+const char* TransitionTable::labelData() const noexcept
+{
+    return labels;
+}
+
+const std::size_t* TransitionTable::targetData() const noexcept
+{
+    return targets;
+}
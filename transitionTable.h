@@ -0,0 +1,111 @@
+#ifndef TRANSITIONTABLE_H
+#define TRANSITIONTABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "transition.h"
+
+/// Immutable CSR storage of the transitions of an automaton:
+/// the edges leaving state s occupy [offsets[s], offsets[s+1]) and are sorted by label, then by target.
+/// Copies share the underlying arrays, which may also be memory owned by someone else (e.g. a mapped file).
+class TransitionTable
+{
+public:
+    /// the arrays of the layout above, for building a table in bulk
+    struct Arrays
+    {
+        std::vector<std::size_t> offsets;
+        std::vector<char> labels;
+        std::vector<std::size_t> targets;
+    };
+private:
+    std::shared_ptr<const void> storage;
+    Arrays* arrays=nullptr; /// the storage, when it is a set of arrays of this class
+    const std::size_t* offsets;
+    const char* labels=nullptr;
+    const std::size_t* targets=nullptr;
+    std::size_t stateCount=0, edgeCount=0;
+public:
+    TransitionTable() noexcept;
+    TransitionTable(std::size_t, std::vector<Transition>);
+    TransitionTable(std::size_t, Transition*, Transition*);
+    explicit TransitionTable(Arrays);
+    TransitionTable(std::size_t, std::size_t, const std::size_t*, const char*, const std::size_t*, std::shared_ptr<const void>) noexcept;
+    std::size_t states() const noexcept;
+    std::size_t size() const noexcept;
+    bool empty() const noexcept;
+    std::size_t begin(std::size_t) const noexcept;
+    std::size_t end(std::size_t) const noexcept;
+    std::size_t lowerBound(std::size_t, char) const noexcept;
+    std::size_t upperBound(std::size_t, char) const noexcept;
+    char label(std::size_t) const noexcept;
+    std::size_t target(std::size_t) const noexcept;
+    template<typename Edges>
+    std::vector<std::size_t> stronglyConnectedComponents(const std::vector<bool>&, Edges, std::size_t&) const;
+    Arrays release() &&;
+    const std::size_t* offsetData() const noexcept;
+    const char* labelData() const noexcept;
+    const std::size_t* targetData() const noexcept;
+};
+
+/// Tarjan's algorithm, without recursion, on the states marked in useful; edges(s) gives the range of the transitions
+/// of state s that are followed. Returns the component of every state (npos for the others) and sets components to their number.
+/// Components are numbered in the order they are completed, so every followed transition leads to a component
+/// with a smaller or equal number.
+template<typename Edges>
+std::vector<std::size_t> TransitionTable::stronglyConnectedComponents(const std::vector<bool>& useful, Edges edges, std::size_t& components) const
+{
+    static constexpr std::size_t npos=-1;
+    std::size_t counter=0;
+    std::vector<std::size_t> index(stateCount, npos), low(stateCount), component(stateCount, npos), stack;
+    /// a state on the path with the next of its transitions and the end of their range
+    struct Frame
+    {
+        std::size_t state, next, last;
+    };
+    std::vector<Frame> path;
+    auto enter=[&](std::size_t s)
+    {
+        index[s]=low[s]=counter++;
+        stack.push_back(s);
+        auto range=edges(s);
+        path.push_back({s, range.first, range.second});
+    };
+    components=0;
+    for(std::size_t root=0; root<stateCount; ++root)
+    {
+        if(!useful[root] || index[root]!=npos) continue;
+        enter(root);
+        while(!path.empty())
+        {
+            auto& f=path.back();
+            auto v=f.state;
+            if(f.next<f.last)
+            {
+                auto t=target(f.next++);
+                if(!useful[t]) continue;
+                if(index[t]==npos) enter(t);
+                else if(component[t]==npos) low[v]=std::min(low[v], index[t]);
+                continue;
+            }
+            path.pop_back();
+            if(!path.empty()) low[path.back().state]=std::min(low[path.back().state], low[v]);
+            if(low[v]!=index[v]) continue;
+            std::size_t w;
+            do
+            {
+                w=stack.back();
+                stack.pop_back();
+                component[w]=components;
+            }
+            while(w!=v);
+            ++components;
+        }
+    }
+    return component;
+}
+
+#endif // TRANSITIONTABLE_H
@@ -0,0 +1,99 @@
+#include "wordEnumerator.h"
+#include <utility>
+
+/// delta is the flat transition table of the automaton, with npos for a missing transition; start is npos if there are no states.
+WordEnumerator::WordEnumerator(std::vector<char> letters, std::vector<std::size_t> delta, std::vector<bool> accepting, std::size_t start):
+    letters(std::move(letters)), delta(std::move(delta)), live{std::move(accepting)}, start(start)
+{
+    seen.emplace(live[0], 0);
+}
+
+/// The table for r remaining letters; past the stored ones it is found in the cycle the tables repeat in.
+const std::vector<bool>& WordEnumerator::liveAt(std::size_t r) const
+{
+    if(r<live.size()) return live[r];
+    return live[cycle+(r-cycle)%(live.size()-cycle)];
+}
+
+/// Extends the word to the current length with the alphabetically first suffix, trying letters from the given one at the
+/// current depth and backtracking when needed; returns false when there is no further word of this length.
+bool WordEnumerator::descend(std::size_t from)
+{
+    std::size_t k=letters.size();
+    while(word.size()<length)
+    {
+        const auto& alive=liveAt(length-word.size()-1);
+        std::size_t a=from;
+        while(a<k && (delta[path.back()*k+a]==npos || !alive[delta[path.back()*k+a]]))
+            ++a;
+        if(a<k)
+        {
+            choice.push_back(a);
+            path.push_back(delta[path.back()*k+a]);
+            word.push_back(letters[a]);
+            from=0;
+            continue;
+        }
+        if(word.empty()) return false;
+        from=choice.back()+1;
+        choice.pop_back();
+        path.pop_back();
+        word.pop_back();
+    }
+    return true;
+}
+
+bool WordEnumerator::next(std::string& res)
+{
+    std::size_t k=letters.size();
+    while(true)
+    {
+        if(started)
+        {
+            if(!word.empty())
+            {
+                auto from=choice.back()+1;
+                choice.pop_back();
+                path.pop_back();
+                word.pop_back();
+                if(descend(from)) break;
+            }
+            started=false;
+            ++length;
+        }
+        if(start==npos) return false;
+        while(cycle==npos && live.size()<=length)
+        {
+            const auto& prev=live.back();
+            std::vector<bool> cur(prev.size());
+            bool any=false;
+            for(std::size_t s=0; s<cur.size(); ++s)
+            {
+                for(std::size_t a=0; a<k && !cur[s]; ++a)
+                    cur[s]=delta[s*k+a]!=npos && prev[delta[s*k+a]];
+                any=any || cur[s];
+            }
+            /// no state accepts a word of this length, hence of any greater one: the language is finite and exhausted
+            if(!any)
+            {
+                start=npos;
+                return false;
+            }
+            auto it=seen.emplace(cur, live.size());
+            if(!it.second) cycle=it.first->second;
+            else live.push_back(std::move(cur));
+        }
+        if(!liveAt(length)[start])
+        {
+            ++length;
+            continue;
+        }
+        path.assign(1, start);
+        choice.clear();
+        word.clear();
+        started=true;
+        if(descend(0)) break;
+    }
+    res=word;
+    return true;
+}
@@ -0,0 +1,36 @@
+#ifndef WORDENUMERATOR_H
+#define WORDENUMERATOR_H
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// Produces the accepted words of a deterministic automaton one at a time in shortlex order (by length, then alphabetically).
+/// Words of each length are found by a depth-first search that only enters states from which a final state can be reached
+/// in exactly the remaining number of steps, so every word costs O(length*letters) and no words are stored.
+/// Each table of such states follows from the one for one step less, so the tables repeat with some period; they are
+/// kept only up to the first repetition, and memory stops growing once the period is found.
+/// Enumeration ends once no state accepts a word of the current length, which happens exactly for finite languages
+/// as long as every state is reachable and co-reachable; Automaton::words leaves the other states without transitions.
+class WordEnumerator
+{
+    static constexpr std::size_t npos=-1;
+    std::vector<char> letters;
+    std::vector<std::size_t> delta;
+    std::vector<std::vector<bool>> live; /// live[r][s]: a final state is reachable from s with exactly r letters
+    std::unordered_map<std::vector<bool>, std::size_t> seen; /// the index in live of every table
+    std::size_t cycle=npos; /// once the tables repeat: live[live.size()] would equal live[cycle]
+    std::size_t start, length=0;
+    std::vector<std::size_t> path, choice;
+    std::string word;
+    bool started=false;
+    WordEnumerator(std::vector<char>, std::vector<std::size_t>, std::vector<bool>, std::size_t);
+    const std::vector<bool>& liveAt(std::size_t) const;
+    bool descend(std::size_t);
+    friend class Automaton;
+public:
+    bool next(std::string&);
+};
+
+#endif // WORDENUMERATOR_H